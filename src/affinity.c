@@ -0,0 +1,190 @@
+#define _GNU_SOURCE
+#include "affinity.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AFFINITY_MAX_NODES 64
+
+typedef struct {
+    int* cpus;      // доступные ядра по узлам (порядок compact)
+    int* nodes;     // узел NUMA каждого ядра из cpus
+    int* scatter;   // порядок scatter: индексы в cpus
+    int count;
+    int node_count;
+    int initialized;
+} CpuTopology;
+
+static AffinityPolicy policy = AFFINITY_NONE;
+static CpuTopology topology;
+static pthread_mutex_t topology_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Формат cpulist из sysfs: "0-3,8-11"
+static void parse_cpulist(const char* text, int node, int* node_of_cpu) {
+    const char* p = text;
+    while (*p) {
+        char* end = NULL;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            if (cpu >= 0) node_of_cpu[cpu] = node;
+        }
+        if (*p != ',') break;
+        p++;
+    }
+}
+
+// Строится один раз, до первой привязки: потом маска процесса сузится до одного ядра
+static void topology_build(void) {
+    pthread_mutex_lock(&topology_mutex);
+    if (topology.initialized) {
+        pthread_mutex_unlock(&topology_mutex);
+        return;
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+    }
+
+    int* node_of_cpu = (int*)malloc(CPU_SETSIZE * sizeof(int));
+    topology.cpus = (int*)malloc(CPU_SETSIZE * sizeof(int));
+    topology.nodes = (int*)malloc(CPU_SETSIZE * sizeof(int));
+    topology.scatter = (int*)malloc(CPU_SETSIZE * sizeof(int));
+    topology.count = 0;
+    topology.node_count = 0;
+    topology.initialized = 1;
+
+    if (!node_of_cpu || !topology.cpus || !topology.nodes || !topology.scatter) {
+        free(node_of_cpu);
+        pthread_mutex_unlock(&topology_mutex);
+        return;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        node_of_cpu[cpu] = -1;
+    }
+
+    for (int node = 0; node < AFFINITY_MAX_NODES; node++) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* file = fopen(path, "r");
+        if (!file) continue;
+        char line[4096];
+        if (fgets(line, sizeof(line), file)) {
+            parse_cpulist(line, node, node_of_cpu);
+        }
+        fclose(file);
+    }
+
+    // Без sysfs (контейнер, не Linux NUMA) все ядра считаются одним узлом
+    int node_sizes[AFFINITY_MAX_NODES] = {0};
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (node_of_cpu[cpu] < 0) node_of_cpu[cpu] = 0;
+        node_sizes[node_of_cpu[cpu]]++;
+    }
+    for (int node = 0; node < AFFINITY_MAX_NODES; node++) {
+        if (node_sizes[node] > 0) topology.node_count++;
+    }
+
+    for (int node = 0; node < AFFINITY_MAX_NODES; node++) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed) && node_of_cpu[cpu] == node) {
+                topology.cpus[topology.count] = cpu;
+                topology.nodes[topology.count] = node;
+                topology.count++;
+            }
+        }
+    }
+
+    // scatter: k-е ядра всех узлов подряд, затем (k+1)-е
+    int node_start[AFFINITY_MAX_NODES];
+    for (int node = 0, offset = 0; node < AFFINITY_MAX_NODES; node++) {
+        node_start[node] = offset;
+        offset += node_sizes[node];
+    }
+    int position = 0;
+    for (int k = 0; position < topology.count; k++) {
+        for (int node = 0; node < AFFINITY_MAX_NODES; node++) {
+            if (k < node_sizes[node]) {
+                topology.scatter[position++] = node_start[node] + k;
+            }
+        }
+    }
+
+    free(node_of_cpu);
+    pthread_mutex_unlock(&topology_mutex);
+}
+
+int affinity_set_policy(const char* name) {
+    if (strcmp(name, "compact") == 0) {
+        policy = AFFINITY_COMPACT;
+    } else if (strcmp(name, "scatter") == 0) {
+        policy = AFFINITY_SCATTER;
+    } else if (strcmp(name, "none") == 0) {
+        policy = AFFINITY_NONE;
+        return 1;
+    } else {
+        return 0;
+    }
+    topology_build();
+    return 1;
+}
+
+AffinityPolicy affinity_get_policy(void) {
+    return policy;
+}
+
+static int topology_slot(int thread_index) {
+    int slot = thread_index % topology.count;
+    return policy == AFFINITY_SCATTER ? topology.scatter[slot] : slot;
+}
+
+int affinity_cpu_for_thread(int thread_index) {
+    if (policy == AFFINITY_NONE) return -1;
+    topology_build();
+    if (topology.count == 0) return -1;
+    return topology.cpus[topology_slot(thread_index)];
+}
+
+void affinity_pin_current(int thread_index) {
+    int cpu = affinity_cpu_for_thread(thread_index);
+    if (cpu < 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+void affinity_print_report(int thread_count) {
+    if (policy == AFFINITY_NONE) {
+        printf("Привязка потоков: нет\n");
+        return;
+    }
+    topology_build();
+
+    printf("Привязка потоков: %s, узлов NUMA: %d, доступно ядер: %d\n",
+           policy == AFFINITY_COMPACT ? "compact" : "scatter", topology.node_count, topology.count);
+    if (topology.count == 0) {
+        printf("  Не удалось определить доступные ядра, потоки не привязаны\n");
+        return;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        int slot = topology_slot(i);
+        printf("  Поток %d -> CPU %d (узел %d)\n", i, topology.cpus[slot], topology.nodes[slot]);
+    }
+    if (thread_count > topology.count) {
+        printf("  Потоков больше, чем ядер: ядра назначаются повторно\n");
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+// Привязка потоков пула к ядрам (--pin):
+// compact - подряд по ядрам одного узла NUMA, затем следующего,
+// scatter - по кругу между узлами, чтобы задействовать память всех узлов
+typedef enum {
+    AFFINITY_NONE,
+    AFFINITY_COMPACT,
+    AFFINITY_SCATTER
+} AffinityPolicy;
+
+int affinity_set_policy(const char* name);
+AffinityPolicy affinity_get_policy(void);
+
+// Ядро для потока пула с данным индексом, -1 без привязки
+int affinity_cpu_for_thread(int thread_index);
+
+// Вызывается самим потоком: поток 0 пула - вызывающий, остальные - рабочие
+void affinity_pin_current(int thread_index);
+
+void affinity_print_report(int thread_count);
+
+#endif
@@ -0,0 +1,451 @@
+#define _DEFAULT_SOURCE
+#include "batch.h"
+#include "determinant.h"
+#include "determinant_batched.h"
+#include "file_io.h"
+#include "thread_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+typedef struct {
+    char* name;
+    char* path;
+    Matrix* matrix;
+    int size;
+} BatchItem;
+
+typedef struct {
+    BatchItem* items;
+    int count;
+    int capacity;
+} BatchList;
+
+typedef struct {
+    BatchList* list;
+    int* small_items;
+    int small_count;
+    int next;
+    int* batched_items;
+    double* load_times;
+    int batched_count;
+    int next_load;
+    BatchOutputFormat format;
+    FILE* out;
+    pthread_mutex_t output_mutex;
+} BatchContext;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char* duplicate_string(const char* text) {
+    size_t length = strlen(text);
+    char* copy = (char*)malloc(length + 1);
+    if (copy) memcpy(copy, text, length + 1);
+    return copy;
+}
+
+static int batch_add(BatchList* list, char* name, char* path, Matrix* matrix, int size) {
+    if (!name || (!path && !matrix)) {
+        free(name);
+        free(path);
+        return 0;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        BatchItem* grown = (BatchItem*)realloc(list->items, capacity * sizeof(BatchItem));
+        if (!grown) {
+            free(name);
+            free(path);
+            return 0;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    BatchItem* item = &list->items[list->count++];
+    item->name = name;
+    item->path = path;
+    item->matrix = matrix;
+    item->size = size;
+    return 1;
+}
+
+static void batch_list_free(BatchList* list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->items[i].name);
+        free(list->items[i].path);
+        matrix_free(list->items[i].matrix);
+    }
+    free(list->items);
+}
+
+static int compare_names(const void* left, const void* right) {
+    return strcmp(*(const char* const*)left, *(const char* const*)right);
+}
+
+static char* join_path(const char* directory, const char* name) {
+    size_t dir_length = strlen(directory);
+    size_t name_length = strlen(name);
+    char* path = (char*)malloc(dir_length + name_length + 2);
+    if (!path) return NULL;
+    memcpy(path, directory, dir_length);
+    path[dir_length] = '/';
+    memcpy(path + dir_length + 1, name, name_length + 1);
+    return path;
+}
+
+static int collect_directory(const char* directory, BatchList* list) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        printf("Ошибка: не удалось открыть каталог '%s'\n", directory);
+        return 0;
+    }
+
+    char** names = NULL;
+    int count = 0, capacity = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char** grown = (char**)realloc(names, capacity * sizeof(char*));
+            if (!grown) break;
+            names = grown;
+        }
+        names[count] = duplicate_string(entry->d_name);
+        if (names[count]) count++;
+    }
+    closedir(dir);
+
+    qsort(names, count, sizeof(char*), compare_names);
+
+    for (int i = 0; i < count; i++) {
+        char* path = join_path(directory, names[i]);
+        struct stat info;
+        int size = -1;
+        if (path && stat(path, &info) == 0 && S_ISREG(info.st_mode)) {
+            size = matrix_peek_file_size(path);
+        }
+        if (size > 0) {
+            batch_add(list, duplicate_string(path), path, NULL, size);
+        } else {
+            free(path);
+        }
+        free(names[i]);
+    }
+    free(names);
+
+    return 1;
+}
+
+static int collect_manifest(const char* manifest, BatchList* list) {
+    FILE* file = fopen(manifest, "r");
+    if (!file) {
+        printf("Ошибка: не удалось открыть манифест '%s'\n", manifest);
+        return 0;
+    }
+
+    // Относительные пути считаются от каталога манифеста
+    char* base = duplicate_string(manifest);
+    char* slash = base ? strrchr(base, '/') : NULL;
+    if (slash) *slash = '\0';
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        char* start = line;
+        while (*start == ' ' || *start == '\t') start++;
+        char* end = start + strlen(start);
+        while (end > start && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+        if (*start == '\0' || *start == '#') continue;
+
+        char* path = (start[0] != '/' && slash) ? join_path(base, start) : duplicate_string(start);
+        int size = path ? matrix_peek_file_size(path) : -1;
+        if (size > 0) {
+            batch_add(list, duplicate_string(start), path, NULL, size);
+        } else {
+            fprintf(stderr, "Ошибка: '%s' не является файлом матрицы, пропущен\n", start);
+            free(path);
+        }
+    }
+
+    free(base);
+    fclose(file);
+    return 1;
+}
+
+static int collect_concatenated(const char* filename, BatchList* list) {
+    Matrix** matrices = NULL;
+    int count = 0;
+    if (!matrix_read_collection(filename, &matrices, &count)) {
+        return 0;
+    }
+
+    size_t name_length = strlen(filename) + 16;
+    for (int i = 0; i < count; i++) {
+        char* name = (char*)malloc(name_length);
+        if (name) snprintf(name, name_length, "%s#%d", filename, i);
+        if (!batch_add(list, name, NULL, matrices[i], matrices[i]->size)) {
+            matrix_free(matrices[i]);
+        }
+    }
+    free(matrices);
+    return 1;
+}
+
+static void write_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_csv_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* p = text; *p; p++) {
+        if (*p == '"') fputc('"', out);
+        fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+static void emit_result(BatchContext* context, int index, const BatchItem* item, const ScaledDeterminant* det,
+                        double load_time, double compute_time, int threads, const char* mode) {
+    FILE* out = context->out;
+    int ok = det != NULL;
+    int sign = ok ? scaled_determinant_sign(det) : 0;
+    double log_abs = ok ? scaled_determinant_log(det) : 0.0;
+    double value = ok ? scaled_determinant_value(det) : 0.0;
+
+    pthread_mutex_lock(&context->output_mutex);
+
+    if (context->format == BATCH_OUTPUT_CSV) {
+        fprintf(out, "%d,", index);
+        write_csv_string(out, item->name);
+        fprintf(out, ",%d,%s,%d,", item->size, ok ? "ok" : "error", sign);
+        if (ok && !isinf(log_abs)) fprintf(out, "%.17g", log_abs);
+        fputc(',', out);
+        if (ok && isfinite(value)) fprintf(out, "%.17g", value);
+        fprintf(out, ",%.9f,%.9f,%d,%s\n", load_time, compute_time, threads, mode);
+    } else {
+        fprintf(out, "{\"index\":%d,\"name\":", index);
+        write_json_string(out, item->name);
+        fprintf(out, ",\"size\":%d,\"status\":\"%s\",\"sign\":%d,\"log_abs_determinant\":", item->size, ok ? "ok" : "error", sign);
+        if (ok && !isinf(log_abs)) fprintf(out, "%.17g", log_abs); else fprintf(out, "null");
+        fprintf(out, ",\"determinant\":");
+        if (ok && isfinite(value)) fprintf(out, "%.17g", value); else fprintf(out, "null");
+        fprintf(out, ",\"load_time\":%.9f,\"time\":%.9f,\"threads\":%d,\"mode\":\"%s\"}\n",
+                load_time, compute_time, threads, mode);
+    }
+    fflush(out);
+
+    pthread_mutex_unlock(&context->output_mutex);
+}
+
+static void process_item(BatchContext* context, int index, int threads) {
+    BatchItem* item = &context->list->items[index];
+    const char* mode = threads > 1 ? "intra" : "inter";
+
+    double load_start = now_seconds();
+    Matrix* matrix = item->matrix;
+    if (!matrix) {
+        matrix = matrix_read_from_file_threads(item->path, threads);
+    }
+    double load_time = now_seconds() - load_start;
+
+    if (!matrix) {
+        emit_result(context, index, item, NULL, load_time, 0.0, threads, mode);
+        return;
+    }
+
+    double start = now_seconds();
+    ScaledDeterminant det = threads > 1
+        ? determinant_get_algorithm()->function(matrix, threads)
+        : determinant_sequential_scaled(matrix);
+    double compute_time = now_seconds() - start;
+
+    emit_result(context, index, item, &det, load_time, compute_time, threads, mode);
+
+    if (matrix != item->matrix) {
+        matrix_free(matrix);
+    } else {
+        matrix_free(item->matrix);
+        item->matrix = NULL;
+    }
+}
+
+// Маленькие матрицы: каждый поток берет следующую целиком, без синхронизации внутри матрицы
+static void small_items_task(void* arg, int thread_index, int thread_count) {
+    BatchContext* context = (BatchContext*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    for (;;) {
+        int k = __atomic_fetch_add(&context->next, 1, __ATOMIC_RELAXED);
+        if (k >= context->small_count) break;
+        process_item(context, context->small_items[k], 1);
+    }
+}
+
+static void load_batched_task(void* arg, int thread_index, int thread_count) {
+    BatchContext* context = (BatchContext*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    for (;;) {
+        int k = __atomic_fetch_add(&context->next_load, 1, __ATOMIC_RELAXED);
+        if (k >= context->batched_count) break;
+        BatchItem* item = &context->list->items[context->batched_items[k]];
+        double start = now_seconds();
+        if (!item->matrix) {
+            item->matrix = matrix_read_from_file_threads(item->path, 1);
+        }
+        context->load_times[k] = now_seconds() - start;
+    }
+}
+
+// Матрицы N <= BATCHED_MAX_SIZE: параллельная загрузка, затем пакетное ядро по группам одного размера.
+// Посчитанные и не загрузившиеся отмечаются в done, остальные уходят обычным путем
+static void run_batched_items(BatchContext* context, int* done, int max_threads) {
+    BatchList* list = context->list;
+    context->batched_count = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->items[i].size >= 1 && list->items[i].size <= BATCHED_MAX_SIZE) {
+            context->batched_items[context->batched_count++] = i;
+        }
+    }
+    int count = context->batched_count;
+    if (count == 0) return;
+
+    context->load_times = (double*)calloc(count, sizeof(double));
+    Matrix** matrices = (Matrix**)malloc(count * sizeof(Matrix*));
+    ScaledDeterminant* results = (ScaledDeterminant*)malloc(count * sizeof(ScaledDeterminant));
+    int* computed = (int*)calloc(count, sizeof(int));
+    if (!context->load_times || !matrices || !results || !computed) {
+        free(context->load_times);
+        context->load_times = NULL;
+        free(matrices);
+        free(results);
+        free(computed);
+        return;
+    }
+
+    context->next_load = 0;
+    thread_pool_run(thread_pool_shared(max_threads), max_threads, load_batched_task, context);
+
+    for (int k = 0; k < count; k++) {
+        matrices[k] = list->items[context->batched_items[k]].matrix;
+    }
+    double start = now_seconds();
+    int computed_count = determinant_batched_matrices(matrices, count, results, computed, max_threads);
+    double per_matrix = computed_count > 0 ? (now_seconds() - start) / computed_count : 0.0;
+
+    for (int k = 0; k < count; k++) {
+        int index = context->batched_items[k];
+        BatchItem* item = &list->items[index];
+        if (!item->matrix) {
+            emit_result(context, index, item, NULL, context->load_times[k], 0.0, 1, "batched");
+        } else if (computed[k]) {
+            emit_result(context, index, item, &results[k], context->load_times[k], per_matrix, 1, "batched");
+            matrix_free(item->matrix);
+            item->matrix = NULL;
+        } else {
+            continue;
+        }
+        done[index] = 1;
+    }
+
+    free(context->load_times);
+    context->load_times = NULL;
+    free(matrices);
+    free(results);
+    free(computed);
+}
+
+int batch_run(const char* path, int max_threads, BatchOutputFormat format, FILE* out) {
+    BatchList list = {NULL, 0, 0};
+
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        printf("Ошибка: '%s' не найден\n", path);
+        return 0;
+    }
+
+    int ok;
+    if (S_ISDIR(info.st_mode)) {
+        ok = collect_directory(path, &list);
+    } else if (matrix_peek_file_size(path) > 0) {
+        ok = collect_concatenated(path, &list);
+    } else {
+        ok = collect_manifest(path, &list);
+    }
+
+    if (!ok) {
+        batch_list_free(&list);
+        return 0;
+    }
+
+    BatchContext context;
+    context.list = &list;
+    context.small_items = (int*)malloc((list.count + 1) * sizeof(int));
+    context.small_count = 0;
+    context.next = 0;
+    context.batched_items = (int*)malloc((list.count + 1) * sizeof(int));
+    context.load_times = NULL;
+    context.batched_count = 0;
+    context.next_load = 0;
+    int* done = (int*)calloc(list.count + 1, sizeof(int));
+    context.format = format;
+    context.out = out;
+    pthread_mutex_init(&context.output_mutex, NULL);
+
+    if (!context.small_items || !context.batched_items || !done) {
+        free(context.small_items);
+        free(context.batched_items);
+        free(done);
+        batch_list_free(&list);
+        return 0;
+    }
+
+    if (format == BATCH_OUTPUT_CSV) {
+        fprintf(out, "index,name,size,status,sign,log_abs_determinant,determinant,load_time,time,threads,mode\n");
+    }
+
+    if (determinant_batched_applies()) {
+        run_batched_items(&context, done, max_threads);
+    }
+
+    for (int i = 0; i < list.count; i++) {
+        if (!done[i] && (list.items[i].size < BATCH_LARGE_SIZE || max_threads == 1)) {
+            context.small_items[context.small_count++] = i;
+        }
+    }
+
+    ThreadPool* pool = thread_pool_shared(max_threads);
+    thread_pool_run(pool, max_threads, small_items_task, &context);
+
+    for (int i = 0; i < list.count; i++) {
+        if (list.items[i].size >= BATCH_LARGE_SIZE && max_threads > 1) {
+            process_item(&context, i, max_threads);
+        }
+    }
+
+    pthread_mutex_destroy(&context.output_mutex);
+    free(context.small_items);
+    free(context.batched_items);
+    free(done);
+    batch_list_free(&list);
+    return 1;
+}
@@ -0,0 +1,19 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+// Матрицы от этого размера считаются по одной всеми потоками,
+// меньшие раздаются потокам целиком, а N <= BATCHED_MAX_SIZE при -a gauss
+// собираются по размерам и идут пакетным ядром (режим "batched")
+#define BATCH_LARGE_SIZE 256
+
+typedef enum {
+    BATCH_OUTPUT_JSONL,
+    BATCH_OUTPUT_CSV
+} BatchOutputFormat;
+
+// path: каталог, файл-манифест (по пути на строку) или файл с несколькими матрицами подряд
+int batch_run(const char* path, int max_threads, BatchOutputFormat format, FILE* out);
+
+#endif
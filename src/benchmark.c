@@ -0,0 +1,281 @@
+#define _POSIX_C_SOURCE 200112L
+#include "benchmark.h"
+#include "determinant.h"
+#include "kernels.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Замер короче этого времени повторяется внутри одного отсчета, иначе его съедает clock_gettime
+#define BENCHMARK_MIN_SAMPLE 1e-3
+#define BENCHMARK_MAX_INNER 1000000
+
+typedef struct {
+    int runs;
+    int inner;
+    double median;
+    double p95;
+    double mean;
+    double stddev;
+    double min;
+    double ci;                  // относительная полуширина 95% интервала
+    ScaledDeterminant determinant;
+} BenchmarkStats;
+
+// Квантиль 0.975 распределения Стьюдента для 1..30 степеней свободы
+static const double student_t975[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void* x, const void* y) {
+    double u = *(const double*)x;
+    double v = *(const double*)y;
+    return (u > v) - (u < v);
+}
+
+void benchmark_config_defaults(BenchmarkConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->warmup = 1;
+    config->min_repeats = 5;
+    config->max_repeats = 100;
+    config->confidence = 0.02;
+    config->max_seconds = 10.0;
+    config->min_val = -10;
+    config->max_val = 10;
+    config->format = BENCHMARK_OUTPUT_TEXT;
+}
+
+int benchmark_parse_list(const char* text, int** values, int* count) {
+    *values = NULL;
+    *count = 0;
+    int capacity = 0;
+    const char* p = text;
+
+    while (*p) {
+        char* end = NULL;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < 1 || value > 1000000 || (*end != ',' && *end != '\0')) {
+            free(*values);
+            *values = NULL;
+            *count = 0;
+            return 0;
+        }
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            int* grown = (int*)realloc(*values, capacity * sizeof(int));
+            if (!grown) {
+                free(*values);
+                *values = NULL;
+                *count = 0;
+                return 0;
+            }
+            *values = grown;
+        }
+        (*values)[(*count)++] = (int)value;
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    return *count > 0;
+}
+
+static ScaledDeterminant run_once(const Matrix* matrix, int threads) {
+    return threads == 0
+        ? determinant_sequential_scaled(matrix)
+        : determinant_get_algorithm()->function(matrix, threads);
+}
+
+static void compute_stats(double* samples, int runs, BenchmarkStats* stats) {
+    double sum = 0.0;
+    for (int i = 0; i < runs; i++) sum += samples[i];
+    stats->mean = sum / runs;
+
+    double squares = 0.0;
+    for (int i = 0; i < runs; i++) {
+        double d = samples[i] - stats->mean;
+        squares += d * d;
+    }
+    stats->stddev = runs > 1 ? sqrt(squares / (runs - 1)) : 0.0;
+
+    stats->ci = 0.0;
+    if (runs > 1 && stats->mean > 0.0) {
+        double t = runs - 1 <= 30 ? student_t975[runs - 2] : 1.96;
+        stats->ci = t * stats->stddev / sqrt((double)runs) / stats->mean;
+    }
+
+    // Сортируется копия: порядок отсчетов нужен для следующей проверки интервала
+    double* sorted = (double*)malloc(runs * sizeof(double));
+    if (!sorted) return;
+    memcpy(sorted, samples, runs * sizeof(double));
+    qsort(sorted, runs, sizeof(double), compare_doubles);
+    stats->min = sorted[0];
+    stats->median = runs % 2 ? sorted[runs / 2] : 0.5 * (sorted[runs / 2 - 1] + sorted[runs / 2]);
+    int p95_rank = (int)ceil(0.95 * runs);
+    stats->p95 = sorted[p95_rank > 0 ? p95_rank - 1 : 0];
+    free(sorted);
+}
+
+// threads == 0 - последовательный эталон
+static int measure(const Matrix* matrix, int threads, const BenchmarkConfig* config, BenchmarkStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    // Хотя бы один прогон нужен всегда: по нему подбирается число повторов внутри отсчета
+    double single = 0.0;
+    for (int i = 0; i < config->warmup || i == 0; i++) {
+        double start = now_seconds();
+        stats->determinant = run_once(matrix, threads);
+        single = now_seconds() - start;
+    }
+
+    stats->inner = 1;
+    if (single < BENCHMARK_MIN_SAMPLE) {
+        double inner = ceil(BENCHMARK_MIN_SAMPLE / (single > 1e-9 ? single : 1e-9));
+        stats->inner = inner > BENCHMARK_MAX_INNER ? BENCHMARK_MAX_INNER : (int)inner;
+    }
+
+    double* samples = (double*)malloc(config->max_repeats * sizeof(double));
+    if (!samples) return 0;
+
+    double budget_start = now_seconds();
+    int runs = 0;
+    while (runs < config->max_repeats) {
+        double start = now_seconds();
+        for (int k = 0; k < stats->inner; k++) {
+            stats->determinant = run_once(matrix, threads);
+        }
+        samples[runs++] = (now_seconds() - start) / stats->inner;
+
+        if (runs >= config->min_repeats) {
+            compute_stats(samples, runs, stats);
+            if (stats->ci <= config->confidence || now_seconds() - budget_start > config->max_seconds) {
+                break;
+            }
+        }
+    }
+
+    stats->runs = runs;
+    compute_stats(samples, runs, stats);
+    free(samples);
+    return 1;
+}
+
+static void write_point(FILE* out, BenchmarkOutputFormat format, int size, int threads, const char* variant,
+                        const BenchmarkStats* stats, double sequential_median) {
+    double n = size;
+    // 2N^3/3 операций LU; трафик - чтение и запись остаточной подматрицы на каждом шаге, 16N^3/3 байт
+    double gflops = stats->median > 0.0 ? 2.0 * n * n * n / 3.0 / stats->median / 1e9 : 0.0;
+    double bandwidth = stats->median > 0.0 ? 16.0 * n * n * n / 3.0 / stats->median / 1e9 : 0.0;
+    double speedup = stats->median > 0.0 ? sequential_median / stats->median : 0.0;
+    double efficiency = speedup / threads;
+    int sign = scaled_determinant_sign(&stats->determinant);
+    double log_abs = scaled_determinant_log(&stats->determinant);
+    double value = scaled_determinant_value(&stats->determinant);
+
+    if (format == BENCHMARK_OUTPUT_TEXT) {
+        fprintf(out, "%6d | %6d | %-10s | %5d | %12.9f | %12.9f | %12.9f | %8.2f | %8.2f | %7.3fx | %6.1f%%\n",
+                size, threads, variant, stats->runs, stats->median, stats->p95, stats->stddev,
+                gflops, bandwidth, speedup, efficiency * 100);
+    } else if (format == BENCHMARK_OUTPUT_CSV) {
+        fprintf(out, "%d,%d,%s,%s,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.6f,%.6f,%.6f,%.6f,%.6f,%d,",
+                size, threads, variant, kernel_name(), stats->runs, stats->inner, stats->median, stats->p95,
+                stats->mean, stats->stddev, stats->min, stats->ci, gflops, bandwidth, speedup, efficiency, sign);
+        if (!isinf(log_abs)) fprintf(out, "%.17g", log_abs);
+        fputc(',', out);
+        if (isfinite(value)) fprintf(out, "%.17g", value);
+        fputc('\n', out);
+    } else {
+        fprintf(out, "{\"size\":%d,\"threads\":%d,\"variant\":\"%s\",\"kernel\":\"%s\",\"runs\":%d,\"inner\":%d,"
+                "\"median\":%.9f,\"p95\":%.9f,\"mean\":%.9f,\"stddev\":%.9f,\"min\":%.9f,\"ci\":%.6f,"
+                "\"gflops\":%.6f,\"bandwidth_gbs\":%.6f,\"speedup\":%.6f,\"efficiency\":%.6f,\"sign\":%d,"
+                "\"log_abs_determinant\":",
+                size, threads, variant, kernel_name(), stats->runs, stats->inner, stats->median, stats->p95,
+                stats->mean, stats->stddev, stats->min, stats->ci, gflops, bandwidth, speedup, efficiency, sign);
+        if (!isinf(log_abs)) fprintf(out, "%.17g", log_abs); else fprintf(out, "null");
+        fprintf(out, ",\"determinant\":");
+        if (isfinite(value)) fprintf(out, "%.17g", value); else fprintf(out, "null");
+        fprintf(out, "}\n");
+    }
+    fflush(out);
+}
+
+int benchmark_run(const BenchmarkConfig* config, FILE* out) {
+    int size_count = config->matrix ? 1 : config->size_count;
+    if (size_count < 1 || config->thread_count < 1 || config->max_repeats < 1) {
+        printf("Ошибка: пустой список размеров или потоков\n");
+        return 0;
+    }
+
+    if (config->format == BENCHMARK_OUTPUT_TEXT) {
+        fprintf(out, "Прогрев: %d, повторов: %d..%d, 95%% ДИ: %.1f%%, алгоритм: %s, ядро: %s",
+                config->warmup, config->min_repeats, config->max_repeats, config->confidence * 100,
+                determinant_get_algorithm()->name, kernel_name());
+        if (!config->matrix) {
+            fprintf(out, ", зерно: %llu", (unsigned long long)matrix_get_random_seed());
+        }
+        fprintf(out, "\n");
+        fprintf(out, "Размер | Потоки | Вариант    | Повт. | Медиана(с)   | p95(с)       | СКО(с)       | ГФлоп/с  | ГБ/с     | Ускор.   | Эффект.\n");
+    } else if (config->format == BENCHMARK_OUTPUT_CSV) {
+        fprintf(out, "size,threads,variant,kernel,runs,inner,median,p95,mean,stddev,min,ci,gflops,bandwidth_gbs,"
+                     "speedup,efficiency,sign,log_abs_determinant,determinant\n");
+    }
+
+    for (int s = 0; s < size_count; s++) {
+        Matrix* generated = NULL;
+        const Matrix* matrix = config->matrix;
+        if (!matrix) {
+            int fill_threads = 1;
+            for (int t = 0; t < config->thread_count; t++) {
+                if (config->threads[t] > fill_threads) fill_threads = config->threads[t];
+            }
+            generated = matrix_create_random(config->sizes[s], config->min_val, config->max_val, fill_threads);
+            if (!generated) {
+                printf("Ошибка создания матрицы %dx%d\n", config->sizes[s], config->sizes[s]);
+                return 0;
+            }
+            matrix = generated;
+        }
+
+        BenchmarkStats sequential;
+        if (!measure(matrix, 0, config, &sequential)) {
+            matrix_free(generated);
+            return 0;
+        }
+        write_point(out, config->format, matrix->size, 1, "sequential", &sequential, sequential.median);
+
+        for (int t = 0; t < config->thread_count; t++) {
+            int threads = config->threads[t];
+            // Пул создается до замеров: его запуск не входит ни в прогрев, ни в отсчеты
+            thread_pool_shared(threads);
+
+            BenchmarkStats parallel;
+            if (!measure(matrix, threads, config, &parallel)) {
+                matrix_free(generated);
+                return 0;
+            }
+            write_point(out, config->format, matrix->size, threads, determinant_get_algorithm()->name,
+                        &parallel, sequential.median);
+
+            int sequential_sign = scaled_determinant_sign(&sequential.determinant);
+            double log_difference = fabs(scaled_determinant_log(&sequential.determinant) -
+                                         scaled_determinant_log(&parallel.determinant));
+            if (sequential_sign != 0 &&
+                (sequential_sign != scaled_determinant_sign(&parallel.determinant) || log_difference > 1e-6)) {
+                fprintf(stderr, "Warning: Results differ! size %d, threads %d, ln|det| difference %.3g\n",
+                        matrix->size, threads, log_difference);
+            }
+        }
+
+        matrix_free(generated);
+    }
+
+    return 1;
+}
@@ -0,0 +1,37 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "matrix.h"
+#include <stdio.h>
+
+typedef enum {
+    BENCHMARK_OUTPUT_TEXT,
+    BENCHMARK_OUTPUT_CSV,
+    BENCHMARK_OUTPUT_JSONL
+} BenchmarkOutputFormat;
+
+typedef struct {
+    const int* sizes;
+    int size_count;
+    const int* threads;
+    int thread_count;
+    const Matrix* matrix;       // если задана, все точки считаются на ней, sizes не используются
+    int warmup;                 // прогревочные прогоны, в статистику не входят
+    int min_repeats;
+    int max_repeats;
+    double confidence;          // допустимая полуширина 95% доверительного интервала среднего, доля от среднего
+    double max_seconds;         // предел времени замеров одной точки
+    int min_val;
+    int max_val;
+    BenchmarkOutputFormat format;
+} BenchmarkConfig;
+
+void benchmark_config_defaults(BenchmarkConfig* config);
+
+// Список вида "1,2,4,8"; память списка освобождает вызывающий
+int benchmark_parse_list(const char* text, int** values, int* count);
+
+// Для каждого размера: последовательный эталон, затем выбранный алгоритм на каждом числе потоков
+int benchmark_run(const BenchmarkConfig* config, FILE* out);
+
+#endif
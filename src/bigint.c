@@ -0,0 +1,392 @@
+#include "bigint.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int bigint_reserve(BigInt* x, int capacity) {
+    if (x->capacity >= capacity) return 1;
+
+    int new_capacity = x->capacity ? x->capacity : 4;
+    while (new_capacity < capacity) new_capacity *= 2;
+
+    uint32_t* limbs = (uint32_t*)realloc(x->limbs, new_capacity * sizeof(uint32_t));
+    if (!limbs) return 0;
+
+    x->limbs = limbs;
+    x->capacity = new_capacity;
+    return 1;
+}
+
+static void bigint_normalize(BigInt* x) {
+    while (x->length > 0 && x->limbs[x->length - 1] == 0) {
+        x->length--;
+    }
+    if (x->length == 0) {
+        x->sign = 0;
+    }
+}
+
+void bigint_init(BigInt* x) {
+    x->limbs = NULL;
+    x->length = 0;
+    x->capacity = 0;
+    x->sign = 0;
+}
+
+void bigint_free(BigInt* x) {
+    free(x->limbs);
+    bigint_init(x);
+}
+
+int bigint_set_int64(BigInt* x, int64_t value) {
+    if (!bigint_reserve(x, 2)) return 0;
+
+    uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    x->limbs[0] = (uint32_t)magnitude;
+    x->limbs[1] = (uint32_t)(magnitude >> 32);
+    x->length = 2;
+    x->sign = value < 0 ? -1 : 1;
+    bigint_normalize(x);
+    return 1;
+}
+
+int bigint_set_limbs(BigInt* x, int sign, const uint32_t* limbs, int length) {
+    if (!bigint_reserve(x, length)) return 0;
+
+    if (length > 0) {
+        memcpy(x->limbs, limbs, length * sizeof(uint32_t));
+    }
+    x->length = length;
+    x->sign = sign;
+    bigint_normalize(x);
+    return 1;
+}
+
+int bigint_copy(BigInt* target, const BigInt* source) {
+    if (target == source) return 1;
+    if (!bigint_reserve(target, source->length)) return 0;
+
+    if (source->length > 0) {
+        memcpy(target->limbs, source->limbs, source->length * sizeof(uint32_t));
+    }
+    target->length = source->length;
+    target->sign = source->sign;
+    return 1;
+}
+
+void bigint_swap(BigInt* x, BigInt* y) {
+    BigInt tmp = *x;
+    *x = *y;
+    *y = tmp;
+}
+
+int bigint_is_zero(const BigInt* x) {
+    return x->sign == 0;
+}
+
+static int compare_magnitude(const BigInt* x, const BigInt* y) {
+    if (x->length != y->length) {
+        return x->length > y->length ? 1 : -1;
+    }
+    for (int i = x->length - 1; i >= 0; i--) {
+        if (x->limbs[i] != y->limbs[i]) {
+            return x->limbs[i] > y->limbs[i] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+int bigint_compare(const BigInt* x, const BigInt* y) {
+    if (x->sign != y->sign) {
+        return x->sign > y->sign ? 1 : -1;
+    }
+    int magnitude = compare_magnitude(x, y);
+    return x->sign >= 0 ? magnitude : -magnitude;
+}
+
+// |result| = |x| + |y|
+static int add_magnitude(BigInt* result, const BigInt* x, const BigInt* y) {
+    if (x->length < y->length) {
+        const BigInt* tmp = x;
+        x = y;
+        y = tmp;
+    }
+    int x_length = x->length;
+    int y_length = y->length;
+
+    if (!bigint_reserve(result, x_length + 1)) return 0;
+
+    const uint32_t* xl = x->limbs;
+    const uint32_t* yl = y->limbs;
+    uint32_t* rl = result->limbs;
+    uint64_t carry = 0;
+
+    for (int i = 0; i < x_length; i++) {
+        uint64_t sum = (uint64_t)xl[i] + (i < y_length ? yl[i] : 0) + carry;
+        rl[i] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+    rl[x_length] = (uint32_t)carry;
+    result->length = x_length + 1;
+    return 1;
+}
+
+// |result| = |x| - |y|, |x| >= |y|
+static int sub_magnitude(BigInt* result, const BigInt* x, const BigInt* y) {
+    int x_length = x->length;
+    int y_length = y->length;
+
+    if (!bigint_reserve(result, x_length)) return 0;
+
+    const uint32_t* xl = x->limbs;
+    const uint32_t* yl = y->limbs;
+    uint32_t* rl = result->limbs;
+    int64_t borrow = 0;
+
+    for (int i = 0; i < x_length; i++) {
+        int64_t diff = (int64_t)xl[i] - (i < y_length ? yl[i] : 0) - borrow;
+        borrow = diff < 0;
+        rl[i] = (uint32_t)(diff + (borrow ? ((int64_t)1 << 32) : 0));
+    }
+    result->length = x_length;
+    return 1;
+}
+
+static int add_signed(BigInt* result, const BigInt* x, const BigInt* y, int y_sign) {
+    if (y_sign == 0) return bigint_copy(result, x);
+    if (x->sign == 0) {
+        if (!bigint_copy(result, y)) return 0;
+        result->sign = y_sign;
+        return 1;
+    }
+
+    int x_sign = x->sign;
+    if (x_sign == y_sign) {
+        if (!add_magnitude(result, x, y)) return 0;
+        result->sign = x_sign;
+    } else {
+        int order = compare_magnitude(x, y);
+        if (order == 0) {
+            result->length = 0;
+            result->sign = 0;
+            return 1;
+        }
+        if (order > 0) {
+            if (!sub_magnitude(result, x, y)) return 0;
+            result->sign = x_sign;
+        } else {
+            if (!sub_magnitude(result, y, x)) return 0;
+            result->sign = y_sign;
+        }
+    }
+
+    bigint_normalize(result);
+    return 1;
+}
+
+int bigint_add(BigInt* result, const BigInt* x, const BigInt* y) {
+    return add_signed(result, x, y, y->sign);
+}
+
+int bigint_sub(BigInt* result, const BigInt* x, const BigInt* y) {
+    return add_signed(result, x, y, -y->sign);
+}
+
+int bigint_mul(BigInt* result, const BigInt* x, const BigInt* y) {
+    if (x->sign == 0 || y->sign == 0) {
+        result->length = 0;
+        result->sign = 0;
+        return 1;
+    }
+
+    BigInt product;
+    bigint_init(&product);
+    BigInt* target = (result == x || result == y) ? &product : result;
+
+    int length = x->length + y->length;
+    if (!bigint_reserve(target, length)) {
+        bigint_free(&product);
+        return 0;
+    }
+
+    uint32_t* rl = target->limbs;
+    memset(rl, 0, length * sizeof(uint32_t));
+
+    for (int i = 0; i < x->length; i++) {
+        uint64_t carry = 0;
+        uint64_t xi = x->limbs[i];
+        for (int j = 0; j < y->length; j++) {
+            uint64_t t = xi * y->limbs[j] + rl[i + j] + carry;
+            rl[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        rl[i + y->length] = (uint32_t)carry;
+    }
+
+    target->length = length;
+    target->sign = x->sign * y->sign;
+    bigint_normalize(target);
+
+    if (target == &product) {
+        bigint_swap(result, &product);
+        bigint_free(&product);
+    }
+    return 1;
+}
+
+static int leading_zeros(uint32_t value) {
+    return value ? __builtin_clz(value) : 32;
+}
+
+// Алгоритм D Кнута (по Hacker's Delight, divmnu): q = u / v, m >= n >= 2
+static void divide_magnitude(uint32_t* q, const uint32_t* u, const uint32_t* v, int m, int n) {
+    const uint64_t base = (uint64_t)1 << 32;
+    uint32_t vn[n];
+    uint32_t un[m + 1];
+
+    int s = leading_zeros(v[n - 1]);
+    for (int i = n - 1; i > 0; i--) {
+        vn[i] = (v[i] << s) | (uint32_t)((uint64_t)v[i - 1] >> (32 - s));
+    }
+    vn[0] = v[0] << s;
+
+    un[m] = (uint32_t)((uint64_t)u[m - 1] >> (32 - s));
+    for (int i = m - 1; i > 0; i--) {
+        un[i] = (u[i] << s) | (uint32_t)((uint64_t)u[i - 1] >> (32 - s));
+    }
+    un[0] = u[0] << s;
+
+    for (int j = m - n; j >= 0; j--) {
+        uint64_t numerator = (uint64_t)un[j + n] * base + un[j + n - 1];
+        uint64_t qhat = numerator / vn[n - 1];
+        uint64_t rhat = numerator - qhat * vn[n - 1];
+
+        while (qhat >= base || qhat * vn[n - 2] > base * rhat + un[j + n - 2]) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= base) break;
+        }
+
+        int64_t k = 0;
+        int64_t t;
+        for (int i = 0; i < n; i++) {
+            uint64_t p = qhat * vn[i];
+            t = (int64_t)un[i + j] - k - (int64_t)(p & 0xFFFFFFFFu);
+            un[i + j] = (uint32_t)t;
+            k = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)un[j + n] - k;
+        un[j + n] = (uint32_t)t;
+
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            q[j]--;
+            uint64_t carry = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                un[i + j] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            un[j + n] += (uint32_t)carry;
+        }
+    }
+}
+
+int bigint_div(BigInt* quotient, const BigInt* x, const BigInt* y) {
+    if (y->sign == 0) return 0;
+
+    if (compare_magnitude(x, y) < 0) {
+        quotient->length = 0;
+        quotient->sign = 0;
+        return 1;
+    }
+
+    int m = x->length;
+    int n = y->length;
+
+    BigInt result;
+    bigint_init(&result);
+    BigInt* target = (quotient == x || quotient == y) ? &result : quotient;
+    if (!bigint_reserve(target, m - n + 1)) return 0;
+
+    if (n == 1) {
+        uint64_t divisor = y->limbs[0];
+        uint64_t remainder = 0;
+        for (int j = m - 1; j >= 0; j--) {
+            uint64_t current = (remainder << 32) | x->limbs[j];
+            target->limbs[j] = (uint32_t)(current / divisor);
+            remainder = current % divisor;
+        }
+        target->length = m;
+    } else {
+        divide_magnitude(target->limbs, x->limbs, y->limbs, m, n);
+        target->length = m - n + 1;
+    }
+
+    target->sign = x->sign * y->sign;
+    bigint_normalize(target);
+
+    if (target == &result) {
+        bigint_swap(quotient, &result);
+        bigint_free(&result);
+    }
+    return 1;
+}
+
+double bigint_log_abs(const BigInt* x) {
+    if (x->sign == 0) return -INFINITY;
+
+    // Старших трех разрядов хватает для double
+    double top = 0.0;
+    int used = x->length < 3 ? x->length : 3;
+    for (int i = 0; i < used; i++) {
+        top = top * 4294967296.0 + x->limbs[x->length - 1 - i];
+    }
+    return log(top) + (double)(x->length - used) * 32.0 * log(2.0);
+}
+
+char* bigint_to_string(const BigInt* x) {
+    if (x->sign == 0) {
+        char* zero = (char*)malloc(2);
+        if (zero) strcpy(zero, "0");
+        return zero;
+    }
+
+    // Делим копию на 10^9 и собираем группы по 9 цифр
+    int length = x->length;
+    uint32_t* work = (uint32_t*)malloc(length * sizeof(uint32_t));
+    int group_capacity = length * 10 / 9 + 2;
+    uint32_t* groups = (uint32_t*)malloc(group_capacity * sizeof(uint32_t));
+    char* text = (char*)malloc((size_t)group_capacity * 9 + 2);
+    if (!work || !groups || !text) {
+        free(work);
+        free(groups);
+        free(text);
+        return NULL;
+    }
+    memcpy(work, x->limbs, length * sizeof(uint32_t));
+
+    int group_count = 0;
+    do {
+        uint64_t remainder = 0;
+        for (int j = length - 1; j >= 0; j--) {
+            uint64_t current = (remainder << 32) | work[j];
+            work[j] = (uint32_t)(current / 1000000000u);
+            remainder = current % 1000000000u;
+        }
+        groups[group_count++] = (uint32_t)remainder;
+        while (length > 0 && work[length - 1] == 0) length--;
+    } while (length > 0);
+
+    char* p = text;
+    if (x->sign < 0) *p++ = '-';
+    p += sprintf(p, "%u", groups[group_count - 1]);
+    for (int i = group_count - 2; i >= 0; i--) {
+        p += sprintf(p, "%09u", groups[i]);
+    }
+
+    free(work);
+    free(groups);
+    return text;
+}
@@ -0,0 +1,39 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <stdint.h>
+
+// Целое произвольной длины: знак и модуль в 32-битных разрядах (младшие первыми)
+typedef struct {
+    uint32_t* limbs;
+    int length;
+    int capacity;
+    int sign;
+} BigInt;
+
+void bigint_init(BigInt* x);
+void bigint_free(BigInt* x);
+
+int bigint_set_int64(BigInt* x, int64_t value);
+// Модуль из разрядов (младшие первыми) и знак -1, 0 или 1
+int bigint_set_limbs(BigInt* x, int sign, const uint32_t* limbs, int length);
+int bigint_copy(BigInt* target, const BigInt* source);
+void bigint_swap(BigInt* x, BigInt* y);
+
+int bigint_compare(const BigInt* x, const BigInt* y);
+int bigint_is_zero(const BigInt* x);
+
+// Результат может совпадать с любым из аргументов
+int bigint_add(BigInt* result, const BigInt* x, const BigInt* y);
+int bigint_sub(BigInt* result, const BigInt* x, const BigInt* y);
+int bigint_mul(BigInt* result, const BigInt* x, const BigInt* y);
+
+// Деление нацело с отбрасыванием остатка (для точного деления в алгоритме Барейса)
+int bigint_div(BigInt* quotient, const BigInt* x, const BigInt* y);
+
+double bigint_log_abs(const BigInt* x);
+
+// Десятичная запись, освобождается free()
+char* bigint_to_string(const BigInt* x);
+
+#endif
@@ -1,22 +1,99 @@
+#define _POSIX_C_SOURCE 200112L
 #include "determinant.h"
+#include "kernels.h"
+#include "trace.h"
+#include "tuning.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
 #define a 1
 
+#ifndef M_LN2
+#define M_LN2 0.69314718055994530942
+#endif
+#ifndef M_LN10
+#define M_LN10 2.30258509299404568402
+#endif
+
 // pivot = опорный элемент
 
-double algorithm_sequential(const Matrix* matrix) {
+ScaledDeterminant scaled_determinant_one(void) {
+    ScaledDeterminant det = {0.5, 1};
+    return det;
+}
+
+ScaledDeterminant scaled_determinant_zero(void) {
+    ScaledDeterminant det = {0.0, 0};
+    return det;
+}
+
+void scaled_determinant_multiply(ScaledDeterminant* det, double value) {
+    int exponent;
+    det->mantissa *= frexp(value, &exponent);
+    det->exponent += exponent;
+
+    // Нормализация после каждого множителя, поэтому ни переполнения, ни потери точности
+    det->mantissa = frexp(det->mantissa, &exponent);
+    det->exponent += exponent;
+
+    if (det->mantissa == 0.0) {
+        det->exponent = 0;
+    }
+}
+
+void scaled_determinant_negate(ScaledDeterminant* det) {
+    det->mantissa = -det->mantissa;
+}
+
+int scaled_determinant_sign(const ScaledDeterminant* det) {
+    return (det->mantissa > 0.0) - (det->mantissa < 0.0);
+}
+
+double scaled_determinant_log(const ScaledDeterminant* det) {
+    if (det->mantissa == 0.0) {
+        return -INFINITY;
+    }
+    return log(fabs(det->mantissa)) + (double)det->exponent * M_LN2;
+}
+
+double scaled_determinant_value(const ScaledDeterminant* det) {
+    if (det->exponent > 1100) {
+        return det->mantissa > 0.0 ? INFINITY : -INFINITY;
+    }
+    if (det->exponent < -1100) {
+        return 0.0 * det->mantissa;
+    }
+    return ldexp(det->mantissa, (int)det->exponent);
+}
+
+void scaled_determinant_format(int sign, double log_abs, char* buffer, size_t buffer_size) {
+    if (sign == 0 || isinf(log_abs)) {
+        snprintf(buffer, buffer_size, "0");
+        return;
+    }
+
+    double log10_abs = log_abs / M_LN10;
+    double exponent10 = floor(log10_abs);
+    double mantissa10 = pow(10.0, log10_abs - exponent10);
+    if (mantissa10 >= 9.9999995) {
+        mantissa10 = 1.0;
+        exponent10 += 1.0;
+    }
+
+    snprintf(buffer, buffer_size, "%s%.6fe%+.0f", sign < 0 ? "-" : "", mantissa10, exponent10);
+}
+
+ScaledDeterminant algorithm_sequential_scaled(const Matrix* matrix) {
     if (!matrix_is_valid(matrix)) {
-        return 0.0;
+        return scaled_determinant_zero();
     }
     
     int n = matrix->size;
     double** temp = copy_matrix_data(matrix);
-    if (!temp) return 0.0;
+    if (!temp) return scaled_determinant_zero();
     
-    double det = 1.0;
+    ScaledDeterminant det = scaled_determinant_one();
     int swap_count = 0;
     const double EPS = 1e-12;
     
@@ -34,15 +111,13 @@ double algorithm_sequential(const Matrix* matrix) {
         
         if (max_val < EPS) {
             free_matrix_data(temp, n);
-            return 0.0;
+            return scaled_determinant_zero();
         }
         
         if (max_row != col) {
-            for (int k = 0; k < n; k++) {
-                double tmp = temp[col][k];
-                temp[col][k] = temp[max_row][k];
-                temp[max_row][k] = tmp;
-            }
+            double* tmp_row = temp[col];
+            temp[col] = temp[max_row];
+            temp[max_row] = tmp_row;
             swap_count++;
         }
         
@@ -51,19 +126,17 @@ double algorithm_sequential(const Matrix* matrix) {
         for (int row = col + 1; row < n; row++) {
             double factor = temp[row][col] / pivot;
             
-            for (int k = col + 1; k < n; k++) {
-                temp[row][k] -= factor * temp[col][k];
-            }
+            row_update(temp[row] + col + 1, temp[col] + col + 1, factor, n - col - 1);
             temp[row][col] = 0.0;
         }
     }
     
     for (int i = 0; i < n; i++) {
-        det *= temp[i][i];
+        scaled_determinant_multiply(&det, temp[i][i]);
     }
     
     if (swap_count % 2 == 1) {
-        det = -det;
+        scaled_determinant_negate(&det);
     }
     
     free_matrix_data(temp, n);
@@ -71,135 +144,346 @@ double algorithm_sequential(const Matrix* matrix) {
     return det;
 }
 
-void* eliminate_rows_thread(void* arg) {
+double algorithm_sequential(const Matrix* matrix) {
+    ScaledDeterminant det = algorithm_sequential_scaled(matrix);
+    return scaled_determinant_value(&det);
+}
+
+void thread_row_range(int begin, int end, int thread_index, int thread_count, int* start_row, int* end_row) {
+    int rows_to_process = end - begin;
+    int rows_per_thread = rows_to_process / thread_count;
+    int extra_rows = rows_to_process % thread_count;
+    *start_row = begin + thread_index * rows_per_thread +
+                 (thread_index < extra_rows ? thread_index : extra_rows);
+    *end_row = *start_row + rows_per_thread + (thread_index < extra_rows ? 1 : 0);
+}
+
+typedef struct {
+    const Matrix* source;
+    double** copy;
+} FirstTouchCopy;
+
+static void first_touch_copy_task(void* arg, int thread_index, int thread_count) {
+    FirstTouchCopy* data = (FirstTouchCopy*)arg;
+    int n = data->source->size;
+    int padding = matrix_stride(n) - n;
+    int start_row, end_row;
+    thread_row_range(0, n, thread_index, thread_count, &start_row, &end_row);
+
+    for (int i = start_row; i < end_row; i++) {
+        memcpy(data->copy[i], data->source->data[i], (size_t)n * sizeof(double));
+        memset(data->copy[i] + n, 0, (size_t)padding * sizeof(double));
+    }
+}
+
+// Рабочую копию заполняют те же потоки, что потом исключают ее строки:
+// при первом касании страницы полосы попадают на узел NUMA своего потока
+double** copy_matrix_data_threads(const Matrix* matrix, int max_threads) {
+    int n = matrix->size;
+    if (max_threads <= 1 || n < FIRST_TOUCH_MIN_SIZE) {
+        return copy_matrix_data(matrix);
+    }
+
+    FirstTouchCopy data;
+    data.source = matrix;
+    data.copy = allocate_matrix_data(n);
+    if (!data.copy) return NULL;
+
+    thread_pool_run(thread_pool_shared(max_threads), max_threads, first_touch_copy_task, &data);
+    return data.copy;
+}
+
+// Поиск опорного элемента только для первого столбца, дальше он совмещен с исключением
+static void pivot_search_task(void* arg, int thread_index, int thread_count) {
     RowEliminationData* data = (RowEliminationData*)arg;
     
+    int column = data->pivot_row + 1;
+    int start_row, end_row;
+    thread_row_range(data->start_row, data->end_row, thread_index, thread_count, &start_row, &end_row);
+    
+    PivotCandidate* candidate = &data->candidates[thread_index];
+    for (int row = start_row; row < end_row; row++) {
+        double val = fabs(data->matrix[row][column]);
+        if (val > candidate->value) {
+            candidate->value = val;
+            candidate->row = row;
+        }
+    }
+}
+
+// Строки [start_row, end_row) с поиском кандидата в опорные для следующего столбца
+static void eliminate_row_range(const RowEliminationData* data, int start_row, int end_row,
+                                double* max_val, int* max_row) {
     double** matrix = data->matrix;
     int size = data->size;
     int pivot_row = data->pivot_row;
     double pivot = matrix[pivot_row][pivot_row];
+    int next_col = pivot_row + 1;
     
-    for (int row = data->start_row; row < data->end_row; row++) {
+    for (int row = start_row; row < end_row; row++) {
         if (row <= pivot_row) continue;
         
         double factor = matrix[row][pivot_row] / pivot;
         
-        for (int col = pivot_row + 1; col < size; col++) {
-            matrix[row][col] -= factor * matrix[pivot_row][col];
-        }
+        row_update(matrix[row] + pivot_row + 1, matrix[pivot_row] + pivot_row + 1, factor, size - pivot_row - 1);
         matrix[row][pivot_row] = 0.0;
+        
+        // Строка только что обновлена и лежит в кэше: сразу кандидат в опорные для col + 1
+        if (next_col < size) {
+            double val = fabs(matrix[row][next_col]);
+            if (val > *max_val || (val == *max_val && row < *max_row)) {
+                *max_val = val;
+                *max_row = row;
+            }
+        }
+    }
+}
+
+void eliminate_rows_task(void* arg, int thread_index, int thread_count) {
+    RowEliminationData* data = (RowEliminationData*)arg;
+    
+    TRACE_BEGIN(span, thread_index);
+    double max_val = -1.0;
+    int max_row = -1;
+    
+    if (data->counters && thread_count > 1) {
+        // Сначала куски своей полосы (строки, тронутые этим потоком при копировании), затем чужих по кругу
+        for (int k = 0; k < thread_count; k++) {
+            int band = (thread_index + k) % thread_count;
+            int band_start, band_end;
+            thread_row_range(data->start_row, data->end_row, band, thread_count, &band_start, &band_end);
+            for (;;) {
+                int begin = band_start + __atomic_fetch_add(&data->counters[band].next, data->chunk, __ATOMIC_RELAXED);
+                if (begin >= band_end) break;
+                int end = begin + data->chunk < band_end ? begin + data->chunk : band_end;
+                eliminate_row_range(data, begin, end, &max_val, &max_row);
+            }
+        }
+    } else {
+        int start_row, end_row;
+        thread_row_range(data->start_row, data->end_row, thread_index, thread_count, &start_row, &end_row);
+        eliminate_row_range(data, start_row, end_row, &max_val, &max_row);
     }
     
-    return NULL;
+    data->candidates[thread_index].value = max_val;
+    data->candidates[thread_index].row = max_row;
+    TRACE_END(span, thread_index, TRACE_ELIMINATE, data->pivot_row);
 }
 
-double algorithm_parallel(const Matrix* matrix, int max_threads) {
+static void reset_pivot_candidates(PivotCandidate* candidates, int count) {
+    for (int t = 0; t < count; t++) {
+        candidates[t].value = -1.0;
+        candidates[t].row = -1;
+    }
+}
+
+// При равных значениях берется меньший номер строки: тот же выбор, что у последовательного поиска,
+// и при динамической раздаче, где куски потоков перемешаны
+static PivotCandidate reduce_pivot_candidates(const PivotCandidate* candidates, int count) {
+    PivotCandidate best = candidates[0];
+    for (int t = 1; t < count; t++) {
+        if (candidates[t].value > best.value ||
+            (candidates[t].value == best.value && candidates[t].row >= 0 && candidates[t].row < best.row)) {
+            best = candidates[t];
+        }
+    }
+    return best;
+}
+
+// Кусок не меньше DYNAMIC_MIN_CHUNK_ELEMENTS элементов, чтобы атомарная операция не стала заметной,
+// и около DYNAMIC_CHUNKS_PER_THREAD кусков на поток, чтобы было что перераспределять
+#define DYNAMIC_MIN_CHUNK_ELEMENTS 8192
+#define DYNAMIC_CHUNKS_PER_THREAD 4
+
+static ScheduleMode schedule_mode = SCHEDULE_DYNAMIC;
+
+static int dynamic_chunk_rows(int rows, int row_length, int threads) {
+    int min_rows = DYNAMIC_MIN_CHUNK_ELEMENTS / (row_length > 0 ? row_length : 1);
+    int chunk = rows / (threads * DYNAMIC_CHUNKS_PER_THREAD);
+    if (chunk < min_rows) chunk = min_rows;
+    return chunk > 0 ? chunk : 1;
+}
+
+ScaledDeterminant algorithm_parallel_scaled(const Matrix* matrix, int max_threads) {
     if (!matrix_is_valid(matrix)) {
-        return 0.0;
+        return scaled_determinant_zero();
     }
     
     int n = matrix->size;
     
-    if (max_threads == 1) {
-        return algorithm_sequential(matrix);
+    // Если уже первый шаг короче порога, пул не будит ни один шаг
+    if (max_threads == 1 || n < tuning_serial_rows(max_threads)) {
+        return algorithm_sequential_scaled(matrix);
     }
     
-    double** temp = copy_matrix_data(matrix);
-    if (!temp) return 0.0;
+    ThreadPool* pool = thread_pool_shared(max_threads);
+    
+    double** temp = copy_matrix_data_threads(matrix, max_threads);
+    if (!temp) return scaled_determinant_zero();
     
-    double det = 1.0;
+    // Кандидаты и счетчики полос - в одном выровненном блоке, по строке кэша на элемент
+    void* candidates_block = NULL;
+    if (posix_memalign(&candidates_block, MATRIX_ALIGNMENT,
+                       max_threads * (sizeof(PivotCandidate) + sizeof(RowCounter))) != 0) {
+        free_matrix_data(temp, n);
+        return algorithm_sequential_scaled(matrix);
+    }
+    PivotCandidate* candidates = (PivotCandidate*)candidates_block;
+    RowCounter* counters = (RowCounter*)(candidates + max_threads);
+    
+    ScaledDeterminant det = scaled_determinant_one();
     int swap_count = 0;
     const double EPS = 1e-12;
     
-    pthread_t* threads = (pthread_t*)malloc(max_threads * sizeof(pthread_t));
-    RowEliminationData* thread_data = (RowEliminationData*)malloc(max_threads * sizeof(RowEliminationData));
+    RowEliminationData step;
+    step.matrix = temp;
+    step.size = n;
+    step.pivot_row = -1;
+    step.start_row = 0;
+    step.end_row = n;
+    step.candidates = candidates;
+    step.counters = NULL;
+    step.chunk = 0;
     
-    if (!threads || !thread_data) {
-        free(threads);
-        free(thread_data);
-        free_matrix_data(temp, n);
-        return algorithm_sequential(matrix);
-    }
+    TRACE_BEGIN(first_pivot_span, 0);
+    reset_pivot_candidates(candidates, max_threads);
+    thread_pool_run(pool, max_threads, pivot_search_task, &step);
+    PivotCandidate best = reduce_pivot_candidates(candidates, max_threads);
+    TRACE_END(first_pivot_span, 0, TRACE_PIVOT, 0);
     
     for (int col = 0; col < n; col++) {
-        int max_row = col;
-        double max_val = fabs(temp[col][col]);
+        int max_row = best.row;
+        double max_val = best.value;
         
-        for (int row = col + 1; row < n; row++) {
-            double val = fabs(temp[row][col]);
-            if (val > max_val) {
-                max_val = val;
-                max_row = row;
-            }
-        }
-        
-        if (max_val < EPS) {
-            free(threads);
-            free(thread_data);
+        if (max_row < 0 || max_val < EPS) {
+            free(candidates);
             free_matrix_data(temp, n);
-            return 0.0;
+            return scaled_determinant_zero();
         }
         
+        TRACE_BEGIN(swap_span, 0);
         if (max_row != col) {
             double* tmp_row = temp[col];
             temp[col] = temp[max_row];
             temp[max_row] = tmp_row;
             swap_count++;
         }
+        TRACE_END(swap_span, 0, TRACE_SWAP, col);
         
         int rows_to_process = n - col - 1;
         
-        if (rows_to_process < max_threads * 2) {
-            double pivot = temp[col][col];
-            for (int row = col + 1; row < n; row++) {
-                double factor = temp[row][col] / pivot;
-                for (int k = col + 1; k < n; k++) {
-                    temp[row][k] -= factor * temp[col][k];
-                }
-                temp[row][col] = 0.0;
-            }
+        step.pivot_row = col;
+        step.start_row = col + 1;
+        step.end_row = n;
+        reset_pivot_candidates(candidates, max_threads);
+        
+        if (rows_to_process < tuning_serial_rows(max_threads)) {
+            eliminate_rows_task(&step, 0, 1);
         } else {
-            int actual_threads = (rows_to_process < max_threads) ? rows_to_process : max_threads;
-            int rows_per_thread = rows_to_process / actual_threads;
-            int extra_rows = rows_to_process % actual_threads;
-            
-            int current_row = col + 1;
-            
-            for (int t = 0; t < actual_threads; t++) {
-                thread_data[t].matrix = temp;
-                thread_data[t].size = n;
-                thread_data[t].pivot_row = col;
-                thread_data[t].start_row = current_row;
-                
-                int rows_for_this_thread = rows_per_thread + (t < extra_rows ? 1 : 0);
-                current_row += rows_for_this_thread;
-                thread_data[t].end_row = current_row;
-                
-                pthread_create(&threads[t], NULL, eliminate_rows_thread, &thread_data[t]);
-            }
-            
-            for (int t = 0; t < actual_threads; t++) {
-                pthread_join(threads[t], NULL);
+            // Потоки пула уже запущены, шаг раздается им без pthread_create/pthread_join
+            if (schedule_mode == SCHEDULE_DYNAMIC) {
+                for (int t = 0; t < max_threads; t++) {
+                    counters[t].next = 0;
+                }
+                step.counters = counters;
+                step.chunk = dynamic_chunk_rows(rows_to_process, n - col - 1, max_threads);
             }
+            TRACE_BEGIN(dispatch_span, 0);
+            thread_pool_run(pool, max_threads, eliminate_rows_task, &step);
+            step.counters = NULL;
+            TRACE_END(dispatch_span, 0, TRACE_DISPATCH, col);
         }
+        
+        TRACE_BEGIN(pivot_span, 0);
+        best = reduce_pivot_candidates(candidates, max_threads);
+        TRACE_END(pivot_span, 0, TRACE_PIVOT, col + 1);
     }
     
     for (int i = 0; i < n; i++) {
-        det *= temp[i][i];
+        scaled_determinant_multiply(&det, temp[i][i]);
     }
     
     // Опытным путем (костыль скорее)
     if (swap_count % 2 == 1) {
-        det = -det;
+        scaled_determinant_negate(&det);
     }
     
-    free(threads);
-    free(thread_data);
+    free(candidates);
     free_matrix_data(temp, n);
     
     return det;
 }
 
+double algorithm_parallel(const Matrix* matrix, int max_threads) {
+    ScaledDeterminant det = algorithm_parallel_scaled(matrix, max_threads);
+    return scaled_determinant_value(&det);
+}
+
+double determinant_sequential(const Matrix* matrix) {
+    return algorithm_sequential(matrix);
+}
+
+double determinant_parallel(const Matrix* matrix, int max_threads) {
+    return algorithm_parallel(matrix, max_threads);
+}
+
+ScaledDeterminant determinant_sequential_scaled(const Matrix* matrix) {
+    return algorithm_sequential_scaled(matrix);
+}
+
+ScaledDeterminant determinant_parallel_scaled(const Matrix* matrix, int max_threads) {
+    return algorithm_parallel_scaled(matrix, max_threads);
+}
+
+static const DeterminantAlgorithm algorithms[] = {
+    {"gauss", determinant_parallel_scaled},
+    {"block", determinant_parallel_block_scaled},
+    {"recursive", determinant_parallel_recursive_scaled},
+    {"tiled", determinant_parallel_tiled_scaled},
+    {"auto", determinant_structured_scaled},
+    {"bareiss", determinant_bareiss_scaled},
+    {"modular", determinant_modular_scaled},
+    {"laplace", determinant_laplace_scaled},
+};
+
+static const DeterminantAlgorithm* selected_algorithm = &algorithms[0];
+
+int determinant_set_schedule(const char* name) {
+    if (strcmp(name, "static") == 0) {
+        schedule_mode = SCHEDULE_STATIC;
+    } else if (strcmp(name, "dynamic") == 0) {
+        schedule_mode = SCHEDULE_DYNAMIC;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+ScheduleMode determinant_get_schedule(void) {
+    return schedule_mode;
+}
+
+int determinant_set_algorithm(const char* name) {
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+        if (strcmp(algorithms[i].name, name) == 0) {
+            selected_algorithm = &algorithms[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const DeterminantAlgorithm* determinant_get_algorithm(void) {
+    return selected_algorithm;
+}
+
+void determinant_print_algorithms(void) {
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+        printf("%s%s", i ? ", " : "", algorithms[i].name);
+    }
+    printf("\n");
+}
+
 double get_time_difference_precise(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
 }
@@ -211,33 +495,45 @@ DeterminantResult determinant_benchmark(const Matrix* matrix, int max_threads) {
         return result;
     }
     
+    // Пул создается один раз до замеров и переиспользуется всеми шагами
+    thread_pool_shared(max_threads);
+    
     struct timespec start, end;
 
     // Sequential
     clock_gettime(CLOCK_MONOTONIC, &start);
-    double seq_det = algorithm_sequential(matrix);
+    ScaledDeterminant seq_det = algorithm_sequential_scaled(matrix);
     clock_gettime(CLOCK_MONOTONIC, &end);
     result.sequential_time = get_time_difference_precise(start, end);
 
-    // Parallel
+    // Parallel: число потоков может урезать профиль --tune для этого размера
+    int threads = tuning_threads_for_size(matrix->size, max_threads);
     clock_gettime(CLOCK_MONOTONIC, &start);
-    double par_det = algorithm_parallel(matrix, max_threads);
+    ScaledDeterminant par_det = selected_algorithm->function(matrix, threads);
     clock_gettime(CLOCK_MONOTONIC, &end);
     result.parallel_time = get_time_difference_precise(start, end);
     
-    result.determinant = par_det;
-    result.threads_used = max_threads;
+    result.determinant = scaled_determinant_value(&par_det);
+    result.sign = scaled_determinant_sign(&par_det);
+    result.log_abs_determinant = scaled_determinant_log(&par_det);
+    result.sequential_log_abs_determinant = scaled_determinant_log(&seq_det);
+    result.threads_used = threads;
     
     if (result.parallel_time > 1e-9) {
         result.speedup = result.sequential_time / result.parallel_time;
-        result.efficiency = result.speedup / max_threads;
+        result.efficiency = result.speedup / threads;
     } else {
         result.speedup = 0.0;
         result.efficiency = 0.0;
     }
     
-    if (fabs(seq_det - par_det) > 1e-6 * fabs(seq_det) && fabs(seq_det) > 1e-12) {
-        printf("Warning: Results differ! Sequential: %g, Parallel: %g\n", seq_det, par_det);
+    // Сравнение по ln|det| работает и там, где сам детерминант не помещается в double
+    int seq_sign = scaled_determinant_sign(&seq_det);
+    double log_difference = fabs(result.sequential_log_abs_determinant - result.log_abs_determinant);
+    if (seq_sign != 0 && (seq_sign != result.sign || log_difference > 1e-6)) {
+        printf("Warning: Results differ! Sequential: %g (ln|det| = %.9g), Parallel: %g (ln|det| = %.9g)\n",
+               scaled_determinant_value(&seq_det), result.sequential_log_abs_determinant,
+               result.determinant, result.log_abs_determinant);
     }
     
     return result;
@@ -249,10 +545,18 @@ void print_benchmark_results(const DeterminantResult* result) {
         return;
     }
     
+    char scaled[64];
+    scaled_determinant_format(result->sign, result->log_abs_determinant, scaled, sizeof(scaled));
+    
     printf("Детерминант: %.6f\n", result->determinant);
+    printf("Детерминант (масштаб.): %s, знак: %d, ln|det|: %.9f\n", scaled, result->sign, result->log_abs_determinant);
     printf("Время последовательно: %.9f сек (%.3f мс)\n", result->sequential_time, result->sequential_time * 1000);
     printf("Время параллельно: %.9f сек (%.3f мс)\n", result->parallel_time, result->parallel_time * 1000);
     printf("Ускорение: %.3fx\n", result->speedup);
     printf("Эффективность: %.2f%% (%.4f)\n", result->efficiency * 100, result->efficiency);
     printf("Потоков использовано: %d\n", result->threads_used);
+    printf("Алгоритм: %s, ядро: %s\n", selected_algorithm->name, kernel_name());
+    if (selected_algorithm->function == determinant_structured_scaled) {
+        printf("Структура: %s\n", determinant_structure_route());
+    }
 }
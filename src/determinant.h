@@ -2,6 +2,7 @@
 #define DETERMINANT_H
 
 #include "matrix.h"
+#include "thread_pool.h"
 #include <pthread.h>
 #include <sys/time.h>
 
@@ -16,17 +17,50 @@ typedef struct {
     pthread_mutex_t* mutex;
 } ThreadData;
 
+// Локальный максимум |a[row][col + 1]|, найденный потоком во время исключения
+typedef struct {
+    double value;
+    int row;
+    char padding[64 - sizeof(double) - sizeof(int)];
+} PivotCandidate;
+
+// Сколько строк своей полосы уже роздано кусками; каждый счетчик на своей строке кэша
+typedef struct {
+    int next;
+    char padding[64 - sizeof(int)];
+} RowCounter;
+
 typedef struct {
     double** matrix;
     int size;
     int pivot_row;
     int start_row;
     int end_row;
+    PivotCandidate* candidates;
+    RowCounter* counters;   // по счетчику на полосу для динамической раздачи, NULL - статические полосы
+    int chunk;
 } RowEliminationData;
 
+// Раздача строк шага исключения (--schedule). Обе начинают с той же полосы thread_row_range,
+// что у первого касания копии; dynamic после своей полосы забирает куски чужих.
+// static строго держит строки на своем потоке: для замеров на NUMA без перераспределения
+typedef enum {
+    SCHEDULE_STATIC,
+    SCHEDULE_DYNAMIC
+} ScheduleMode;
+
+
+// Детерминант без переполнения: mantissa * 2^exponent, 0.5 <= |mantissa| < 1 (или 0)
+typedef struct {
+    double mantissa;
+    long exponent;
+} ScaledDeterminant;
 
 typedef struct {
     double determinant;
+    int sign;
+    double log_abs_determinant;
+    double sequential_log_abs_determinant;
     double sequential_time;
     double parallel_time;
     double speedup;
@@ -44,6 +78,79 @@ double determinant_parallel_ultimate(const Matrix* matrix, int max_threads);
 double determinant_parallel_demo(const Matrix* matrix, int max_threads);
 double determinant_parallel_block(const Matrix* matrix, int max_threads);
 
+ScaledDeterminant determinant_sequential_scaled(const Matrix* matrix);
+ScaledDeterminant determinant_parallel_scaled(const Matrix* matrix, int max_threads);
+ScaledDeterminant determinant_parallel_block_scaled(const Matrix* matrix, int max_threads);
+ScaledDeterminant determinant_parallel_recursive_scaled(const Matrix* matrix, int max_threads);
+ScaledDeterminant determinant_parallel_tiled_scaled(const Matrix* matrix, int max_threads);
+// Треугольная, блочно-диагональная, ленточная или сводимая RCM к ленте (rcm-band) - свое ядро, иначе блочное LU
+ScaledDeterminant determinant_structured_scaled(const Matrix* matrix, int max_threads);
+const char* determinant_structure_route(void);
+// Блочное LU на месте: строки a переставляются указателями, под диагональю остаются множители L.
+// Возвращает 0 для вырожденной матрицы
+int lu_factor_block(double** a, int n, int max_threads, int* swap_count);
+
+// Точные алгоритмы для целочисленных матриц (exact.c, determinant_modular.c)
+ScaledDeterminant determinant_bareiss_scaled(const Matrix* matrix, int max_threads);
+ScaledDeterminant determinant_modular_scaled(const Matrix* matrix, int max_threads);
+// Разложение Лапласа с запоминанием миноров (N <= 24), для проверки LU
+ScaledDeterminant determinant_laplace_scaled(const Matrix* matrix, int max_threads);
+
+// Смешанная точность: факторизация во float, при большой оценке погрешности - пересчет в double
+typedef enum {
+    PRECISION_DOUBLE,
+    PRECISION_FLOAT,
+    PRECISION_MIXED
+} PrecisionMode;
+
+typedef struct {
+    ScaledDeterminant determinant;
+    double float_log_abs_determinant;
+    double error_estimate;      // оценка абсолютной погрешности ln|det| факторизации во float
+    int used_double;
+    double float_time;
+    double total_time;
+} MixedPrecisionResult;
+
+MixedPrecisionResult determinant_mixed_precision(const Matrix* matrix, int max_threads,
+                                                 PrecisionMode mode, double tolerance);
+void print_mixed_precision_result(const MixedPrecisionResult* result, PrecisionMode mode, double tolerance);
+
+// Строки [begin, end) делятся между потоками непрерывными полосами
+void thread_row_range(int begin, int end, int thread_index, int thread_count, int* start_row, int* end_row);
+
+// Один шаг исключения над полосой строк потока, arg - RowEliminationData
+void eliminate_rows_task(void* arg, int thread_index, int thread_count);
+
+// Меньшие копии целиком помещаются в кэш, раздача пулу не окупается
+#define FIRST_TOUCH_MIN_SIZE 256
+double** copy_matrix_data_threads(const Matrix* matrix, int max_threads);
+
+// Накопление произведения опорных элементов и преобразования
+ScaledDeterminant scaled_determinant_one(void);
+ScaledDeterminant scaled_determinant_zero(void);
+void scaled_determinant_multiply(ScaledDeterminant* det, double value);
+void scaled_determinant_negate(ScaledDeterminant* det);
+int scaled_determinant_sign(const ScaledDeterminant* det);
+double scaled_determinant_log(const ScaledDeterminant* det);
+double scaled_determinant_value(const ScaledDeterminant* det);
+void scaled_determinant_format(int sign, double log_abs, char* buffer, size_t buffer_size);
+
+// Выбор параллельного алгоритма для бенчмарка (-a)
+typedef ScaledDeterminant (*DeterminantFunction)(const Matrix* matrix, int max_threads);
+
+typedef struct {
+    const char* name;
+    DeterminantFunction function;
+} DeterminantAlgorithm;
+
+int determinant_set_algorithm(const char* name);
+const DeterminantAlgorithm* determinant_get_algorithm(void);
+void determinant_print_algorithms(void);
+
+int determinant_set_schedule(const char* name);
+ScheduleMode determinant_get_schedule(void);
+
 // Бенчмарк
 DeterminantResult determinant_benchmark(const Matrix* matrix, int max_threads);
 void print_benchmark_results(const DeterminantResult* result);
@@ -0,0 +1,290 @@
+#include "determinant_batched.h"
+#include "determinant.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BATCHED_EPS 1e-12
+
+typedef void (*BatchedKernel)(double* restrict soa, double* restrict det);
+
+typedef struct {
+    const double* matrices;
+    double* out;
+    int n;
+    int count;
+    int groups;
+    BatchedKernel kernel;
+} BatchedData;
+
+#define AT(row, col, lane) soa[((row) * KERNEL_SIZE + (col)) * BATCHED_LANES + (lane)]
+
+// Ядро для фиксированного N: все циклы с известными границами, внутренний цикл по
+// BATCHED_LANES матрицам без ветвлений, поэтому компилятор разворачивает и векторизует его
+#define DEFINE_BATCHED_KERNEL(N, SUFFIX, ATTRIBUTES) \
+ATTRIBUTES static void batched_kernel_##N##SUFFIX(double* restrict soa, double* restrict det) { \
+    enum { KERNEL_SIZE = N }; \
+    for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+        det[lane] = 1.0; \
+    } \
+    for (int col = 0; col < N; col++) { \
+        double best[BATCHED_LANES]; \
+        int pivot_row[BATCHED_LANES]; \
+        for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+            best[lane] = fabs(AT(col, col, lane)); \
+            pivot_row[lane] = col; \
+        } \
+        for (int row = col + 1; row < N; row++) { \
+            for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+                double val = fabs(AT(row, col, lane)); \
+                int better = val > best[lane]; \
+                best[lane] = better ? val : best[lane]; \
+                pivot_row[lane] = better ? row : pivot_row[lane]; \
+            } \
+        } \
+        for (int k = col; k < N; k++) { \
+            for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+                int row = pivot_row[lane]; \
+                double upper = AT(col, k, lane); \
+                double lower = AT(row, k, lane); \
+                AT(row, k, lane) = upper; \
+                AT(col, k, lane) = lower; \
+            } \
+        } \
+        double inverse[BATCHED_LANES]; \
+        for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+            double pivot = AT(col, col, lane); \
+            int regular = best[lane] >= BATCHED_EPS; \
+            double sign = pivot_row[lane] != col ? -1.0 : 1.0; \
+            det[lane] *= regular ? pivot * sign : 0.0; \
+            inverse[lane] = regular ? 1.0 / pivot : 0.0; \
+        } \
+        for (int row = col + 1; row < N; row++) { \
+            double factor[BATCHED_LANES]; \
+            for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+                factor[lane] = AT(row, col, lane) * inverse[lane]; \
+            } \
+            for (int k = col + 1; k < N; k++) { \
+                for (int lane = 0; lane < BATCHED_LANES; lane++) { \
+                    AT(row, k, lane) -= factor[lane] * AT(col, k, lane); \
+                } \
+            } \
+        } \
+    } \
+}
+
+#define DEFINE_BATCHED_KERNELS(SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(1, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(2, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(3, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(4, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(5, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(6, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(7, SUFFIX, ATTRIBUTES) \
+    DEFINE_BATCHED_KERNEL(8, SUFFIX, ATTRIBUTES) \
+    static const BatchedKernel batched_kernels##SUFFIX[BATCHED_MAX_SIZE + 1] = { \
+        NULL, \
+        batched_kernel_1##SUFFIX, batched_kernel_2##SUFFIX, batched_kernel_3##SUFFIX, batched_kernel_4##SUFFIX, \
+        batched_kernel_5##SUFFIX, batched_kernel_6##SUFFIX, batched_kernel_7##SUFFIX, batched_kernel_8##SUFFIX, \
+    };
+
+DEFINE_BATCHED_KERNELS(_generic, )
+
+#if defined(__x86_64__) || defined(__i386__)
+// Та же развертка под AVX2/FMA: 8 дорожек = два 256-битных регистра
+DEFINE_BATCHED_KERNELS(_avx2, __attribute__((target("avx2,fma"))))
+#define BATCHED_HAS_AVX2 1
+#endif
+
+#undef AT
+
+static const BatchedKernel* select_batched_kernels(void) {
+#ifdef BATCHED_HAS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return batched_kernels_avx2;
+    }
+#endif
+    return batched_kernels_generic;
+}
+
+// Группа матриц переставляется в чередующийся вид, недостающие дополняются единичными
+static void batched_groups_task(void* arg, int thread_index, int thread_count) {
+    BatchedData* data = (BatchedData*)arg;
+    int n = data->n;
+    int elements = n * n;
+
+    double soa[BATCHED_MAX_SIZE * BATCHED_MAX_SIZE * BATCHED_LANES];
+    double det[BATCHED_LANES];
+
+    int groups_per_thread = data->groups / thread_count;
+    int extra_groups = data->groups % thread_count;
+    int first = thread_index * groups_per_thread + (thread_index < extra_groups ? thread_index : extra_groups);
+    int last = first + groups_per_thread + (thread_index < extra_groups ? 1 : 0);
+
+    for (int group = first; group < last; group++) {
+        int base = group * BATCHED_LANES;
+        int lanes = data->count - base < BATCHED_LANES ? data->count - base : BATCHED_LANES;
+
+        for (int lane = 0; lane < BATCHED_LANES; lane++) {
+            if (lane < lanes) {
+                const double* source = data->matrices + (size_t)(base + lane) * elements;
+                for (int e = 0; e < elements; e++) {
+                    soa[e * BATCHED_LANES + lane] = source[e];
+                }
+            } else {
+                for (int e = 0; e < elements; e++) {
+                    soa[e * BATCHED_LANES + lane] = (e % (n + 1) == 0) ? 1.0 : 0.0;
+                }
+            }
+        }
+
+        data->kernel(soa, det);
+
+        memcpy(data->out + base, det, lanes * sizeof(double));
+    }
+}
+
+int determinant_batched(const double* matrices, int n, int count, double* out, int max_threads) {
+    if (!matrices || !out || n < 1 || n > BATCHED_MAX_SIZE || count < 0) {
+        return 0;
+    }
+
+    BatchedData data;
+    data.matrices = matrices;
+    data.out = out;
+    data.n = n;
+    data.count = count;
+    data.groups = (count + BATCHED_LANES - 1) / BATCHED_LANES;
+    data.kernel = select_batched_kernels()[n];
+
+    int threads = max_threads < data.groups ? max_threads : data.groups;
+    if (threads <= 1) {
+        batched_groups_task(&data, 0, 1);
+    } else {
+        thread_pool_run(thread_pool_shared(max_threads), threads, batched_groups_task, &data);
+    }
+
+    return 1;
+}
+
+int determinant_batched_applies(void) {
+    return determinant_get_algorithm()->function == determinant_parallel_scaled;
+}
+
+int determinant_batched_matrices(Matrix* const* matrices, int count, ScaledDeterminant* results, int* done,
+                                 int max_threads) {
+    int* indices = (int*)malloc((count + 1) * sizeof(int));
+    if (!indices) return 0;
+
+    int computed = 0;
+    for (int n = 1; n <= BATCHED_MAX_SIZE; n++) {
+        int group = 0;
+        for (int i = 0; i < count; i++) {
+            if (matrices[i] && matrices[i]->size == n && !done[i]) {
+                indices[group++] = i;
+            }
+        }
+        if (group == 0) continue;
+
+        int elements = n * n;
+        double* packed = (double*)malloc((size_t)group * elements * sizeof(double));
+        double* out = (double*)malloc((size_t)group * sizeof(double));
+        if (!packed || !out) {
+            free(packed);
+            free(out);
+            continue;
+        }
+        for (int k = 0; k < group; k++) {
+            const Matrix* matrix = matrices[indices[k]];
+            for (int i = 0; i < n; i++) {
+                memcpy(packed + (size_t)k * elements + i * n, matrix->data[i], n * sizeof(double));
+            }
+        }
+
+        if (determinant_batched(packed, n, group, out, max_threads)) {
+            for (int k = 0; k < group; k++) {
+                ScaledDeterminant det = scaled_determinant_one();
+                scaled_determinant_multiply(&det, out[k]);
+                results[indices[k]] = det;
+                done[indices[k]] = 1;
+            }
+            computed += group;
+        }
+        free(packed);
+        free(out);
+    }
+
+    free(indices);
+    return computed;
+}
+
+static double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+void batched_benchmark(int n, int count, int max_threads, int min_val, int max_val) {
+    if (n < 1 || n > BATCHED_MAX_SIZE || count < 1 || min_val >= max_val) {
+        printf("Ошибка: пакетное ядро поддерживает размеры 1..%d\n", BATCHED_MAX_SIZE);
+        return;
+    }
+
+    int elements = n * n;
+    double* matrices = (double*)malloc((size_t)count * elements * sizeof(double));
+    double* batched = (double*)malloc((size_t)count * sizeof(double));
+    double* reference = (double*)malloc((size_t)count * sizeof(double));
+    Matrix* single = matrix_create(n);
+
+    if (!matrices || !batched || !reference || !single) {
+        printf("Ошибка: недостаточно памяти для %d матриц %dx%d\n", count, n, n);
+        free(matrices);
+        free(batched);
+        free(reference);
+        matrix_free(single);
+        return;
+    }
+
+    for (size_t e = 0; e < (size_t)count * elements; e++) {
+        matrices[e] = matrix_random_value(e, min_val, max_val);
+    }
+
+    thread_pool_shared(max_threads);
+
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int m = 0; m < count; m++) {
+        for (int i = 0; i < n; i++) {
+            memcpy(single->data[i], matrices + (size_t)m * elements + i * n, n * sizeof(double));
+        }
+        reference[m] = determinant_sequential(single);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double sequential_time = elapsed_seconds(start, end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    determinant_batched(matrices, n, count, batched, max_threads);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double batched_time = elapsed_seconds(start, end);
+
+    double max_error = 0.0;
+    for (int m = 0; m < count; m++) {
+        double scale = fabs(reference[m]) > 1.0 ? fabs(reference[m]) : 1.0;
+        double error = fabs(batched[m] - reference[m]) / scale;
+        if (error > max_error) max_error = error;
+    }
+
+    printf("Матриц: %d размера %dx%d, потоков: %d, в группе: %d\n", count, n, n, max_threads, BATCHED_LANES);
+    printf("Время поматрично: %.9f сек (%.3f мкс на матрицу)\n", sequential_time, sequential_time * 1e6 / count);
+    printf("Время пакетно: %.9f сек (%.3f мкс на матрицу)\n", batched_time, batched_time * 1e6 / count);
+    printf("Ускорение: %.3fx\n", batched_time > 1e-12 ? sequential_time / batched_time : 0.0);
+    printf("Макс. относительное расхождение: %.3e\n", max_error);
+
+    free(matrices);
+    free(batched);
+    free(reference);
+    matrix_free(single);
+}
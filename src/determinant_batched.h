@@ -0,0 +1,27 @@
+#ifndef DETERMINANT_BATCHED_H
+#define DETERMINANT_BATCHED_H
+
+// Пакетный расчет множества маленьких матриц одного размера:
+// BATCHED_LANES матриц чередуются поэлементно (structure of arrays) и исключаются одновременно
+#define BATCHED_LANES 8
+#define BATCHED_MAX_SIZE 8
+
+#include "determinant.h"
+
+// matrices: count матриц n x n подряд по строкам, out: count детерминантов.
+// Возвращает 0, если размер не поддерживается
+int determinant_batched(const double* matrices, int n, int count, double* out, int max_threads);
+
+// Матрицы вперемешку (пакет --batch, сервер): N <= BATCHED_MAX_SIZE собираются по размерам
+// и считаются determinant_batched, у посчитанных done[i] = 1, остальные (и NULL) не трогаются.
+// Вызывать вне задач пула. Возвращает число посчитанных
+int determinant_batched_matrices(Matrix* const* matrices, int count, ScaledDeterminant* results, int* done,
+                                 int max_threads);
+
+// Пакетное ядро повторяет исключение -a gauss: для других алгоритмов пакет и сервер его не используют
+int determinant_batched_applies(void);
+
+// Сравнение с поматричным последовательным алгоритмом на случайных данных (--batched)
+void batched_benchmark(int n, int count, int max_threads, int min_val, int max_val);
+
+#endif
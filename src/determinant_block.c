@@ -0,0 +1,162 @@
+#include "determinant.h"
+#include "kernels.h"
+#include "tuning.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Блочное LU (right-looking): узкая панель + обновление хвоста блоками
+
+#define TILE_COLUMNS 256
+
+typedef struct {
+    double** matrix;
+    int size;
+    int panel_start;
+    int panel_width;
+} TrailingUpdateData;
+
+// Факторизация панели [k0, k0 + kb) по всем строкам ниже k0, строки меняются указателями
+static int factor_panel(double** a, int n, int k0, int kb, int* swap_count) {
+    const double EPS = 1e-12;
+    int panel_end = k0 + kb;
+
+    for (int j = k0; j < panel_end; j++) {
+        int max_row = j;
+        double max_val = fabs(a[j][j]);
+
+        for (int row = j + 1; row < n; row++) {
+            double val = fabs(a[row][j]);
+            if (val > max_val) {
+                max_val = val;
+                max_row = row;
+            }
+        }
+
+        if (max_val < EPS) {
+            return 0;
+        }
+
+        if (max_row != j) {
+            double* tmp_row = a[j];
+            a[j] = a[max_row];
+            a[max_row] = tmp_row;
+            (*swap_count)++;
+        }
+
+        double pivot = a[j][j];
+        const double* pivot_row = a[j];
+
+        for (int row = j + 1; row < n; row++) {
+            double* current = a[row];
+            double factor = current[j] / pivot;
+            current[j] = factor;
+            row_update(current + j + 1, pivot_row + j + 1, factor, panel_end - j - 1);
+        }
+    }
+
+    return 1;
+}
+
+// Каждый поток владеет полосой столбцов хвоста: сначала TRSM для U12, затем A22 -= L21 * U12
+static void trailing_update_task(void* arg, int thread_index, int thread_count) {
+    TrailingUpdateData* data = (TrailingUpdateData*)arg;
+
+    double** a = data->matrix;
+    int n = data->size;
+    int k0 = data->panel_start;
+    int panel_end = k0 + data->panel_width;
+
+    int columns = n - panel_end;
+    int tiles = (columns + 7) / 8;
+    int tiles_per_thread = tiles / thread_count;
+    int extra_tiles = tiles % thread_count;
+    int first_tile = thread_index * tiles_per_thread + (thread_index < extra_tiles ? thread_index : extra_tiles);
+    int last_tile = first_tile + tiles_per_thread + (thread_index < extra_tiles ? 1 : 0);
+
+    int col_begin = panel_end + first_tile * 8;
+    int col_end = panel_end + last_tile * 8;
+    if (col_end > n) col_end = n;
+    if (col_begin >= col_end) return;
+
+    for (int r = k0 + 1; r < panel_end; r++) {
+        double* target = a[r];
+        for (int p = k0; p < r; p++) {
+            row_update(target + col_begin, a[p] + col_begin, target[p], col_end - col_begin);
+        }
+    }
+
+    for (int c0 = col_begin; c0 < col_end; c0 += TILE_COLUMNS) {
+        int c1 = c0 + TILE_COLUMNS < col_end ? c0 + TILE_COLUMNS : col_end;
+
+        for (int row = panel_end; row < n; row++) {
+            double* target = a[row];
+            for (int p = k0; p < panel_end; p++) {
+                double factor = target[p];
+                if (factor == 0.0) continue;
+                row_update(target + c0, a[p] + c0, factor, c1 - c0);
+            }
+        }
+    }
+}
+
+int lu_factor_block(double** a, int n, int max_threads, int* swap_count) {
+    ThreadPool* pool = thread_pool_shared(max_threads);
+
+    int block_size = tuning.block_size;
+
+    for (int k0 = 0; k0 < n; k0 += block_size) {
+        int kb = (n - k0 < block_size) ? n - k0 : block_size;
+
+        if (!factor_panel(a, n, k0, kb, swap_count)) {
+            return 0;
+        }
+
+        if (k0 + kb < n) {
+            TrailingUpdateData update;
+            update.matrix = a;
+            update.size = n;
+            update.panel_start = k0;
+            update.panel_width = kb;
+
+            thread_pool_run(pool, max_threads, trailing_update_task, &update);
+        }
+    }
+
+    return 1;
+}
+
+ScaledDeterminant determinant_parallel_block_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return scaled_determinant_zero();
+    }
+
+    int n = matrix->size;
+
+    double** temp = copy_matrix_data_threads(matrix, max_threads);
+    if (!temp) return scaled_determinant_zero();
+
+    int swap_count = 0;
+
+    if (!lu_factor_block(temp, n, max_threads, &swap_count)) {
+        free_matrix_data(temp, n);
+        return scaled_determinant_zero();
+    }
+
+    ScaledDeterminant det = scaled_determinant_one();
+    for (int i = 0; i < n; i++) {
+        scaled_determinant_multiply(&det, temp[i][i]);
+    }
+
+    if (swap_count % 2 == 1) {
+        scaled_determinant_negate(&det);
+    }
+
+    free_matrix_data(temp, n);
+
+    return det;
+}
+
+double determinant_parallel_block(const Matrix* matrix, int max_threads) {
+    ScaledDeterminant det = determinant_parallel_block_scaled(matrix, max_threads);
+    return scaled_determinant_value(&det);
+}
@@ -0,0 +1,286 @@
+#include "exact.h"
+#include "determinant.h"
+#include "task_scheduler.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Разложение по строкам "по определению" без копий миноров: минор строк 0..k-1
+// и множества столбцов S задается битовой маской S. Миноры слоя k зависят только
+// от слоя k - 1, поэтому каждый считается один раз (динамика по подмножествам),
+// а слой делится на куски-задачи для планировщика с перехватом работы
+
+#define LAPLACE_MAX_SIZE 24
+#define LAPLACE_MIN_CHUNK 1024
+// Запас под частичные суммы: |сумма| <= sqrt(N) * оценка Адамара < 2^127
+#define LAPLACE_EXACT_MAX_BITS 120.0
+
+typedef __int128 int128_t;
+
+typedef struct {
+    const Matrix* matrix;
+    int size;
+    int exact;
+    int max_threads;
+    uint64_t binomial[LAPLACE_MAX_SIZE + 1][LAPLACE_MAX_SIZE + 1];
+    int64_t integers[LAPLACE_MAX_SIZE][LAPLACE_MAX_SIZE];
+
+    // Слои миноров: индекс - ранг маски в колексикографическом порядке
+    void* previous;
+    void* current;
+    int layer;
+
+    double result;
+    int128_t exact_result;
+} LaplaceData;
+
+typedef struct {
+    LaplaceData* data;
+    uint64_t begin;
+    uint64_t end;
+} LaplaceChunk;
+
+// Маска с рангом rank среди k-подмножеств {0..n-1} (колекс = возрастание масок)
+static uint32_t unrank_subset(const LaplaceData* data, uint64_t rank, int k) {
+    uint32_t mask = 0;
+    int c = data->size - 1;
+    for (int i = k; i >= 1; i--) {
+        while (data->binomial[c][i] > rank) c--;
+        mask |= 1u << c;
+        rank -= data->binomial[c][i];
+        c--;
+    }
+    return mask;
+}
+
+// Следующая маска с тем же числом единиц (Gosper)
+static uint32_t next_subset(uint32_t mask) {
+    uint32_t lowest = mask & (0u - mask);
+    uint32_t ripple = mask + lowest;
+    return ripple | (((mask ^ ripple) >> 2) / lowest);
+}
+
+static void laplace_chunk_task(void* arg) {
+    LaplaceChunk* chunk = (LaplaceChunk*)arg;
+    LaplaceData* data = chunk->data;
+    int k = data->layer;
+    const double* row = data->matrix->data[k - 1];
+    const int64_t* integer_row = data->integers[k - 1];
+
+    int columns[LAPLACE_MAX_SIZE];
+    uint64_t low[LAPLACE_MAX_SIZE];
+    uint64_t high[LAPLACE_MAX_SIZE];
+
+    uint32_t mask = unrank_subset(data, chunk->begin, k);
+    for (uint64_t rank = chunk->begin; rank < chunk->end; rank++, mask = next_subset(mask)) {
+        // Ранг S \ {c_t} = sum_{i<t} C(c_i, i+1) + sum_{i>t} C(c_i, i)
+        uint64_t high_total = 0;
+        int count = 0;
+        for (uint32_t bits = mask; bits; bits &= bits - 1) {
+            int c = __builtin_ctz(bits);
+            columns[count] = c;
+            low[count] = data->binomial[c][count + 1];
+            high[count] = data->binomial[c][count];
+            high_total += high[count];
+            count++;
+        }
+
+        uint64_t low_prefix = 0;
+        uint64_t high_prefix = 0;
+
+        // Разложение по последней строке минора: знак (-1)^(k - 1 + t)
+        if (data->exact) {
+            const int128_t* previous = (const int128_t*)data->previous;
+            int128_t sum = 0;
+            for (int t = 0; t < count; t++) {
+                high_prefix += high[t];
+                int64_t entry = integer_row[columns[t]];
+                if (entry != 0) {
+                    int128_t term = (int128_t)entry * previous[low_prefix + high_total - high_prefix];
+                    sum += ((k - 1 + t) & 1) ? -term : term;
+                }
+                low_prefix += low[t];
+            }
+            ((int128_t*)data->current)[rank] = sum;
+        } else {
+            const double* previous = (const double*)data->previous;
+            double sum = 0.0;
+            for (int t = 0; t < count; t++) {
+                high_prefix += high[t];
+                double entry = row[columns[t]];
+                if (entry != 0.0) {
+                    double term = entry * previous[low_prefix + high_total - high_prefix];
+                    sum += ((k - 1 + t) & 1) ? -term : term;
+                }
+                low_prefix += low[t];
+            }
+            ((double*)data->current)[rank] = sum;
+        }
+    }
+}
+
+static void laplace_root(void* arg) {
+    LaplaceData* data = (LaplaceData*)arg;
+    int n = data->size;
+
+    if (data->exact) {
+        ((int128_t*)data->previous)[0] = 1;
+    } else {
+        ((double*)data->previous)[0] = 1.0;
+    }
+
+    for (int k = 1; k <= n; k++) {
+        uint64_t count = data->binomial[n][k];
+        uint64_t chunk_size = count / ((uint64_t)data->max_threads * 8) + 1;
+        if (chunk_size < LAPLACE_MIN_CHUNK) chunk_size = LAPLACE_MIN_CHUNK;
+        int chunk_count = (int)((count + chunk_size - 1) / chunk_size);
+
+        LaplaceChunk* chunks = (LaplaceChunk*)malloc(chunk_count * sizeof(LaplaceChunk));
+        data->layer = k;
+
+        if (!chunks) {
+            LaplaceChunk whole = {data, 0, count};
+            laplace_chunk_task(&whole);
+        } else {
+            TaskGroup group;
+            task_group_init(&group);
+            for (int c = 0; c < chunk_count; c++) {
+                chunks[c].data = data;
+                chunks[c].begin = (uint64_t)c * chunk_size;
+                chunks[c].end = chunks[c].begin + chunk_size < count ? chunks[c].begin + chunk_size : count;
+                if (c > 0) task_spawn(&group, laplace_chunk_task, &chunks[c]);
+            }
+            laplace_chunk_task(&chunks[0]);
+            task_wait(&group);
+            free(chunks);
+        }
+
+        void* tmp = data->previous;
+        data->previous = data->current;
+        data->current = tmp;
+    }
+
+    if (data->exact) {
+        data->exact_result = ((int128_t*)data->previous)[0];
+    } else {
+        data->result = ((double*)data->previous)[0];
+    }
+}
+
+static int is_exact_candidate(const Matrix* matrix) {
+    if (!matrix_is_integer(matrix)) return 0;
+
+    double bound = 0.5 * log2((double)matrix->size);
+    for (int i = 0; i < matrix->size; i++) {
+        double norm = 0.0;
+        for (int j = 0; j < matrix->size; j++) {
+            norm += matrix->data[i][j] * matrix->data[i][j];
+        }
+        if (norm > 0.0) bound += 0.5 * log2(norm);
+    }
+    return bound < LAPLACE_EXACT_MAX_BITS;
+}
+
+// Возвращает 0, если размер вне [1, LAPLACE_MAX_SIZE] или не хватило памяти
+static int run_laplace(const Matrix* matrix, int max_threads, int exact, LaplaceData* data) {
+    int n = matrix->size;
+    if (n < 1 || n > LAPLACE_MAX_SIZE) return 0;
+
+    data->matrix = matrix;
+    data->size = n;
+    data->exact = exact;
+    data->max_threads = max_threads > 0 ? max_threads : 1;
+
+    for (int i = 0; i <= n; i++) {
+        data->binomial[i][0] = 1;
+        for (int j = 1; j <= n; j++) {
+            data->binomial[i][j] = i == 0 ? 0 : data->binomial[i - 1][j - 1] + data->binomial[i - 1][j];
+        }
+    }
+    if (exact) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                data->integers[i][j] = (int64_t)matrix->data[i][j];
+            }
+        }
+    }
+
+    uint64_t widest = data->binomial[n][n / 2];
+    size_t element = exact ? sizeof(int128_t) : sizeof(double);
+    data->previous = malloc(widest * element);
+    data->current = malloc(widest * element);
+    if (!data->previous || !data->current) {
+        free(data->previous);
+        free(data->current);
+        return 0;
+    }
+
+    task_scheduler_run(data->max_threads, laplace_root, data);
+
+    free(data->previous);
+    free(data->current);
+    return 1;
+}
+
+int determinant_laplace_exact(const Matrix* matrix, int max_threads, BigInt* result) {
+    if (!matrix_is_valid(matrix) || !is_exact_candidate(matrix)) {
+        return 0;
+    }
+
+    LaplaceData* data = (LaplaceData*)malloc(sizeof(LaplaceData));
+    if (!data) return 0;
+
+    int ok = run_laplace(matrix, max_threads, 1, data);
+    if (ok) {
+        int128_t value = data->exact_result;
+        unsigned __int128 magnitude = value < 0 ? -(unsigned __int128)value : (unsigned __int128)value;
+        uint32_t limbs[4];
+        for (int i = 0; i < 4; i++) {
+            limbs[i] = (uint32_t)(magnitude >> (32 * i));
+        }
+        ok = bigint_set_limbs(result, value < 0 ? -1 : (value > 0 ? 1 : 0), limbs, 4);
+    }
+
+    free(data);
+    return ok;
+}
+
+ScaledDeterminant determinant_laplace_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return scaled_determinant_zero();
+    }
+
+    // Больше 2^24 миноров не считаем: блочное LU, но не молча - laplace выбирают как сверку с LU.
+    // В stderr и один раз за процесс, чтобы не портить вывод JSON пакета и сервера
+    if (matrix->size > LAPLACE_MAX_SIZE) {
+        static int warned = 0;
+        if (!__atomic_exchange_n(&warned, 1, __ATOMIC_RELAXED)) {
+            fprintf(stderr, "Внимание: laplace только для N <= %d, матрица %dx%d посчитана блочным LU\n",
+                    LAPLACE_MAX_SIZE, matrix->size, matrix->size);
+        }
+        return determinant_parallel_block_scaled(matrix, max_threads);
+    }
+
+    if (is_exact_candidate(matrix)) {
+        BigInt det;
+        bigint_init(&det);
+        ScaledDeterminant scaled = scaled_determinant_zero();
+        if (determinant_laplace_exact(matrix, max_threads, &det)) {
+            scaled = bigint_to_scaled_determinant(&det);
+        }
+        bigint_free(&det);
+        return scaled;
+    }
+
+    LaplaceData* data = (LaplaceData*)malloc(sizeof(LaplaceData));
+    if (!data) return scaled_determinant_zero();
+
+    ScaledDeterminant det = scaled_determinant_zero();
+    if (run_laplace(matrix, max_threads, 0, data)) {
+        det = scaled_determinant_one();
+        scaled_determinant_multiply(&det, data->result);
+    }
+    free(data);
+    return det;
+}
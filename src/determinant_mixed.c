@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "determinant.h"
+#include "kernels.h"
+#include "thread_pool.h"
+#include "tuning.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MIXED_PROBES 4
+
+typedef struct {
+    float** matrix;
+    int size;
+    int pivot_row;
+    int start_row;
+    int end_row;
+} FloatEliminationData;
+
+// Как eliminate_rows_task, но во float и с сохранением множителей L под диагональю
+static void eliminate_rows_float_task(void* arg, int thread_index, int thread_count) {
+    FloatEliminationData* data = (FloatEliminationData*)arg;
+
+    float** matrix = data->matrix;
+    int size = data->size;
+    int pivot_row = data->pivot_row;
+    float pivot = matrix[pivot_row][pivot_row];
+
+    int start_row, end_row;
+    thread_row_range(data->start_row, data->end_row, thread_index, thread_count, &start_row, &end_row);
+
+    for (int row = start_row; row < end_row; row++) {
+        float factor = matrix[row][pivot_row] / pivot;
+        matrix[row][pivot_row] = factor;
+        row_update_float(matrix[row] + pivot_row + 1, matrix[pivot_row] + pivot_row + 1, factor, size - pivot_row - 1);
+    }
+}
+
+// PA = LU во float. Возвращает 0 для вырожденной (в одинарной точности) матрицы
+static int factor_float(MatrixFloat* lu, int max_threads, int* swap_count) {
+    const float EPS = 1e-12f;
+    int n = lu->size;
+    float** a = lu->data;
+    ThreadPool* pool = thread_pool_shared(max_threads);
+
+    FloatEliminationData step;
+    step.matrix = a;
+    step.size = n;
+
+    for (int col = 0; col < n; col++) {
+        int max_row = col;
+        float max_val = fabsf(a[col][col]);
+        for (int row = col + 1; row < n; row++) {
+            float val = fabsf(a[row][col]);
+            if (val > max_val) {
+                max_val = val;
+                max_row = row;
+            }
+        }
+
+        if (!(max_val >= EPS) || isinf(max_val)) {
+            return 0;
+        }
+
+        if (max_row != col) {
+            float* tmp_row = a[col];
+            a[col] = a[max_row];
+            a[max_row] = tmp_row;
+            (*swap_count)++;
+        }
+
+        step.pivot_row = col;
+        step.start_row = col + 1;
+        step.end_row = n;
+
+        if (n - col - 1 < tuning_serial_rows(max_threads)) {
+            eliminate_rows_float_task(&step, 0, 1);
+        } else {
+            thread_pool_run(pool, max_threads, eliminate_rows_float_task, &step);
+        }
+    }
+
+    return 1;
+}
+
+static uint64_t probe_state_next(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Ошибка факторизации E = LU - PA сдвигает ln|det| примерно на tr((LU)^-1 E).
+// След оценивается по Хатчинсону: z^T (LU)^-1 E z для случайных z из {-1, 1};
+// E z считается в double через невязку, поэтому оценка апостериорная
+static double estimate_log_error(const Matrix* matrix, const MatrixFloat* lu) {
+    int n = lu->size;
+    float** f = lu->data;
+
+    double* z = (double*)malloc(n * sizeof(double));
+    double* w = (double*)malloc(n * sizeof(double));
+    double* e = (double*)malloc(n * sizeof(double));
+    int* permutation = (int*)malloc(n * sizeof(int));
+    if (!z || !w || !e || !permutation) {
+        free(z);
+        free(w);
+        free(e);
+        free(permutation);
+        return INFINITY;
+    }
+
+    for (int i = 0; i < n; i++) {
+        permutation[i] = (int)((f[i] - lu->values) / lu->stride);
+    }
+
+    uint64_t state = 0x5DEECE66Dull;
+    double sum_squares = 0.0;
+
+    for (int probe = 0; probe < MIXED_PROBES; probe++) {
+        for (int i = 0; i < n; i++) {
+            z[i] = (probe_state_next(&state) & 1) ? 1.0 : -1.0;
+        }
+
+        // w = U z
+        for (int i = 0; i < n; i++) {
+            double sum = 0.0;
+            for (int j = i; j < n; j++) sum += (double)f[i][j] * z[j];
+            w[i] = sum;
+        }
+
+        // e = L w - P A z
+        for (int i = n - 1; i >= 0; i--) {
+            double sum = w[i];
+            for (int j = 0; j < i; j++) sum += (double)f[i][j] * w[j];
+            const double* original = matrix->data[permutation[i]];
+            for (int j = 0; j < n; j++) sum -= original[j] * z[j];
+            e[i] = sum;
+        }
+
+        // e = U^-1 L^-1 e
+        for (int i = 0; i < n; i++) {
+            double sum = e[i];
+            for (int j = 0; j < i; j++) sum -= (double)f[i][j] * e[j];
+            e[i] = sum;
+        }
+        for (int i = n - 1; i >= 0; i--) {
+            double sum = e[i];
+            for (int j = i + 1; j < n; j++) sum -= (double)f[i][j] * e[j];
+            e[i] = sum / f[i][i];
+        }
+
+        double trace = 0.0;
+        for (int i = 0; i < n; i++) trace += z[i] * e[i];
+        sum_squares += trace * trace;
+    }
+
+    free(z);
+    free(w);
+    free(e);
+    free(permutation);
+
+    double estimate = sqrt(sum_squares / MIXED_PROBES);
+    return isfinite(estimate) ? estimate : INFINITY;
+}
+
+static double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+MixedPrecisionResult determinant_mixed_precision(const Matrix* matrix, int max_threads,
+                                                 PrecisionMode mode, double tolerance) {
+    MixedPrecisionResult result = {0};
+    result.determinant = scaled_determinant_zero();
+    result.error_estimate = INFINITY;
+    result.float_log_abs_determinant = -INFINITY;
+
+    if (!matrix_is_valid(matrix)) {
+        return result;
+    }
+
+    struct timespec start, float_end, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (mode != PRECISION_DOUBLE) {
+        MatrixFloat* lu = matrix_float_from_matrix(matrix);
+        int swap_count = 0;
+        if (lu && factor_float(lu, max_threads, &swap_count)) {
+            ScaledDeterminant det = scaled_determinant_one();
+            for (int i = 0; i < lu->size; i++) {
+                scaled_determinant_multiply(&det, lu->data[i][i]);
+            }
+            if (swap_count % 2 == 1) {
+                scaled_determinant_negate(&det);
+            }
+
+            result.determinant = det;
+            result.float_log_abs_determinant = scaled_determinant_log(&det);
+            result.error_estimate = estimate_log_error(matrix, lu);
+        }
+        matrix_float_free(lu);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &float_end);
+    result.float_time = elapsed_seconds(start, float_end);
+
+    int need_double = mode == PRECISION_DOUBLE ||
+                      (mode == PRECISION_MIXED && !(result.error_estimate <= tolerance));
+    if (need_double) {
+        result.determinant = determinant_get_algorithm()->function(matrix, max_threads);
+        result.used_double = 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    result.total_time = elapsed_seconds(start, end);
+    return result;
+}
+
+void print_mixed_precision_result(const MixedPrecisionResult* result, PrecisionMode mode, double tolerance) {
+    if (!result) {
+        return;
+    }
+
+    int sign = scaled_determinant_sign(&result->determinant);
+    double log_abs = scaled_determinant_log(&result->determinant);
+    char scaled[64];
+    scaled_determinant_format(sign, log_abs, scaled, sizeof(scaled));
+
+    printf("Детерминант: %.6f\n", scaled_determinant_value(&result->determinant));
+    printf("Детерминант (масштаб.): %s, знак: %d, ln|det|: %.9f\n", scaled, sign, log_abs);
+
+    if (mode != PRECISION_DOUBLE) {
+        printf("ln|det| во float: %.9f, оценка погрешности ln|det|: %.3e (допуск %.3e)\n",
+               result->float_log_abs_determinant, result->error_estimate, tolerance);
+        printf("Время float: %.9f сек (%.3f мс)\n", result->float_time, result->float_time * 1000);
+    }
+    if (result->used_double && mode == PRECISION_MIXED) {
+        printf("Оценка погрешности выше допуска: пересчитано в double (%s)\n", determinant_get_algorithm()->name);
+    }
+    printf("Точность: %s\n", result->used_double ? "double" : "float");
+    printf("Общее время: %.9f сек (%.3f мс)\n", result->total_time, result->total_time * 1000);
+}
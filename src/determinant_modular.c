@@ -0,0 +1,319 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "exact.h"
+#include "determinant.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Простые чуть меньше 2^62: произведение в Монтгомери (R = 2^64) не переполняет 128 бит
+#define MODULAR_PRIME_LIMIT ((uint64_t)1 << 62)
+#define MODULAR_PRIME_BITS 61.99
+
+typedef unsigned __int128 uint128_t;
+
+typedef struct {
+    uint64_t prime;
+    uint64_t inverse;     // -prime^-1 mod 2^64
+    uint64_t r_squared;   // 2^128 mod prime
+} Modulus;
+
+typedef struct {
+    const Matrix* matrix;
+    const Modulus* moduli;
+    uint64_t* residues;
+    int prime_count;
+    int next_prime;
+    int failed;
+} ModularData;
+
+static uint64_t mulmod(uint64_t x, uint64_t y, uint64_t m) {
+    return (uint64_t)((uint128_t)x * y % m);
+}
+
+static uint64_t powmod(uint64_t base, uint64_t power, uint64_t m) {
+    uint64_t result = 1 % m;
+    base %= m;
+    while (power) {
+        if (power & 1) result = mulmod(result, base, m);
+        base = mulmod(base, base, m);
+        power >>= 1;
+    }
+    return result;
+}
+
+// Детерминированный Миллер-Рабин: этих оснований достаточно для всех 64-битных чисел
+static int is_prime(uint64_t n) {
+    static const uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+    if (n < 2) return 0;
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        if (n % bases[i] == 0) return n == bases[i];
+    }
+
+    uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        uint64_t x = powmod(bases[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+
+        int composite = 1;
+        for (int r = 1; r < s; r++) {
+            x = mulmod(x, x, n);
+            if (x == n - 1) {
+                composite = 0;
+                break;
+            }
+        }
+        if (composite) return 0;
+    }
+    return 1;
+}
+
+static Modulus make_modulus(uint64_t prime) {
+    Modulus m;
+    m.prime = prime;
+
+    uint64_t inverse = prime;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - prime * inverse;
+    }
+    m.inverse = (uint64_t)0 - inverse;
+
+    uint128_t r = ((uint128_t)1 << 64) % prime;
+    m.r_squared = (uint64_t)(r * r % prime);
+    return m;
+}
+
+static inline uint64_t montgomery_reduce(uint128_t t, const Modulus* m) {
+    uint64_t q = (uint64_t)t * m->inverse;
+    uint64_t result = (uint64_t)((t + (uint128_t)q * m->prime) >> 64);
+    return result >= m->prime ? result - m->prime : result;
+}
+
+static inline uint64_t montgomery_multiply(uint64_t x, uint64_t y, const Modulus* m) {
+    return montgomery_reduce((uint128_t)x * y, m);
+}
+
+static uint64_t montgomery_power(uint64_t base, uint64_t power, uint64_t one, const Modulus* m) {
+    uint64_t result = one;
+    while (power) {
+        if (power & 1) result = montgomery_multiply(result, base, m);
+        base = montgomery_multiply(base, base, m);
+        power >>= 1;
+    }
+    return result;
+}
+
+// det mod p гауссовым исключением в целых (в форме Монтгомери)
+static uint64_t determinant_mod_prime(const Matrix* matrix, const Modulus* m, uint64_t* work) {
+    int n = matrix->size;
+    uint64_t p = m->prime;
+    uint64_t one = montgomery_multiply(1, m->r_squared, m);
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int64_t value = (int64_t)matrix->data[i][j];
+            uint64_t residue = value < 0 ? (p - ((uint64_t)0 - (uint64_t)value) % p) % p : (uint64_t)value % p;
+            work[(size_t)i * n + j] = montgomery_multiply(residue, m->r_squared, m);
+        }
+    }
+
+    uint64_t det = one;
+    int negative = 0;
+
+    for (int k = 0; k < n; k++) {
+        uint64_t* pivot_row = work + (size_t)k * n;
+
+        int found = k;
+        while (found < n && work[(size_t)found * n + k] == 0) found++;
+        if (found == n) return 0;
+
+        if (found != k) {
+            uint64_t* other = work + (size_t)found * n;
+            for (int j = k; j < n; j++) {
+                uint64_t tmp = pivot_row[j];
+                pivot_row[j] = other[j];
+                other[j] = tmp;
+            }
+            negative = !negative;
+        }
+
+        det = montgomery_multiply(det, pivot_row[k], m);
+        uint64_t pivot_inverse = montgomery_power(pivot_row[k], p - 2, one, m);
+
+        for (int i = k + 1; i < n; i++) {
+            uint64_t* row = work + (size_t)i * n;
+            if (row[k] == 0) continue;
+
+            uint64_t factor = montgomery_multiply(row[k], pivot_inverse, m);
+            for (int j = k + 1; j < n; j++) {
+                uint64_t product = montgomery_multiply(factor, pivot_row[j], m);
+                uint64_t value = row[j] - product;
+                row[j] = row[j] < product ? value + p : value;
+            }
+        }
+    }
+
+    det = montgomery_reduce(det, m);
+    return negative && det ? p - det : det;
+}
+
+// Каждый поток берет следующий простой модуль, пока они не закончатся
+static void modular_primes_task(void* arg, int thread_index, int thread_count) {
+    ModularData* data = (ModularData*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    int n = data->matrix->size;
+    uint64_t* work = (uint64_t*)malloc((size_t)n * n * sizeof(uint64_t));
+    if (!work) {
+        data->failed = 1;
+        return;
+    }
+
+    for (;;) {
+        int index = __atomic_fetch_add(&data->next_prime, 1, __ATOMIC_RELAXED);
+        if (index >= data->prime_count) break;
+        data->residues[index] = determinant_mod_prime(data->matrix, &data->moduli[index], work);
+    }
+
+    free(work);
+}
+
+// log2 оценки Адамара: |det| <= prod ||row_i||
+static double hadamard_bound_log2(const Matrix* matrix) {
+    double bound = 0.0;
+    for (int i = 0; i < matrix->size; i++) {
+        double norm = 0.0;
+        for (int j = 0; j < matrix->size; j++) {
+            norm += matrix->data[i][j] * matrix->data[i][j];
+        }
+        if (norm == 0.0) return -1.0;
+        bound += 0.5 * log2(norm);
+    }
+    return bound;
+}
+
+// Гарнер: смешанная система счисления, затем значение по схеме Горнера
+static int reconstruct_crt(const Modulus* moduli, const uint64_t* residues, int count, BigInt* result) {
+    uint64_t* digits = (uint64_t*)malloc(count * sizeof(uint64_t));
+    if (!digits) return 0;
+
+    for (int i = 0; i < count; i++) {
+        uint64_t p = moduli[i].prime;
+        uint64_t value = 0;
+        uint64_t product = 1 % p;
+        for (int j = 0; j < i; j++) {
+            value = (value + mulmod(digits[j] % p, product, p)) % p;
+            product = mulmod(product, moduli[j].prime % p, p);
+        }
+        uint64_t difference = residues[i] >= value ? residues[i] - value : residues[i] + p - value;
+        digits[i] = mulmod(difference, powmod(product, p - 2, p), p);
+    }
+
+    BigInt value, modulus, term;
+    bigint_init(&value);
+    bigint_init(&modulus);
+    bigint_init(&term);
+
+    int ok = bigint_set_int64(&value, 0) && bigint_set_int64(&modulus, 1);
+    for (int i = count - 1; ok && i >= 0; i--) {
+        ok = bigint_set_int64(&term, (int64_t)moduli[i].prime) &&
+             bigint_mul(&value, &value, &term) &&
+             bigint_set_int64(&term, (int64_t)digits[i]) &&
+             bigint_add(&value, &value, &term);
+    }
+
+    // Представитель в (-M/2, M/2]
+    for (int i = 0; ok && i < count; i++) {
+        ok = bigint_set_int64(&term, (int64_t)moduli[i].prime) && bigint_mul(&modulus, &modulus, &term);
+    }
+    if (ok) {
+        ok = bigint_add(&term, &value, &value);
+        if (ok && bigint_compare(&term, &modulus) > 0) {
+            ok = bigint_sub(&value, &value, &modulus);
+        }
+    }
+    if (ok) {
+        bigint_swap(result, &value);
+    }
+
+    bigint_free(&value);
+    bigint_free(&modulus);
+    bigint_free(&term);
+    free(digits);
+    return ok;
+}
+
+int determinant_modular(const Matrix* matrix, int max_threads, BigInt* result, int* primes_used) {
+    if (!matrix_is_integer(matrix)) {
+        return 0;
+    }
+
+    if (primes_used) *primes_used = 0;
+
+    double bound = hadamard_bound_log2(matrix);
+    if (bound < 0.0) {
+        return bigint_set_int64(result, 0);
+    }
+
+    // Нужно покрыть 2 * bound, чтобы восстановить и знак
+    int prime_count = (int)ceil((bound + 1.0) / MODULAR_PRIME_BITS);
+    if (prime_count < 1) prime_count = 1;
+
+    Modulus* moduli = (Modulus*)malloc(prime_count * sizeof(Modulus));
+    uint64_t* residues = (uint64_t*)malloc(prime_count * sizeof(uint64_t));
+    if (!moduli || !residues) {
+        free(moduli);
+        free(residues);
+        return 0;
+    }
+
+    uint64_t candidate = MODULAR_PRIME_LIMIT - 1;
+    for (int found = 0; found < prime_count; candidate -= 2) {
+        if (is_prime(candidate)) {
+            moduli[found++] = make_modulus(candidate);
+        }
+    }
+
+    ModularData data;
+    data.matrix = matrix;
+    data.moduli = moduli;
+    data.residues = residues;
+    data.prime_count = prime_count;
+    data.next_prime = 0;
+    data.failed = 0;
+
+    int thread_count = max_threads < prime_count ? max_threads : prime_count;
+    thread_pool_run(thread_pool_shared(max_threads), thread_count, modular_primes_task, &data);
+
+    int ok = !data.failed && reconstruct_crt(moduli, residues, prime_count, result);
+    if (ok && primes_used) *primes_used = prime_count;
+
+    free(moduli);
+    free(residues);
+    return ok;
+}
+
+ScaledDeterminant determinant_modular_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_integer(matrix)) {
+        return determinant_parallel_scaled(matrix, max_threads);
+    }
+
+    BigInt det;
+    bigint_init(&det);
+    ScaledDeterminant scaled = scaled_determinant_zero();
+    if (determinant_modular(matrix, max_threads, &det, NULL)) {
+        scaled = bigint_to_scaled_determinant(&det);
+    }
+    bigint_free(&det);
+    return scaled;
+}
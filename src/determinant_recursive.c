@@ -0,0 +1,236 @@
+#include "determinant.h"
+#include "kernels.h"
+#include "task_scheduler.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Рекурсивное LU (Toledo): левая половина столбцов факторизуется рекурсивно,
+// затем правая обновляется (TRSM + GEMM) и факторизуется так же.
+// Размер блоков подстраивается под кэш сам собой, без настройки под машину
+
+#define RECURSIVE_BASE_COLUMNS 32
+#define UPDATE_LEAF_COLUMNS 128
+#define UPDATE_LEAF_ROWS 64
+
+typedef struct {
+    double** matrix;
+    int size;
+    int swap_count;
+    int failed;
+} RecursiveLU;
+
+// Блок обновления: строки [row_begin, row_end) и столбцы [col_begin, col_end)
+// с внутренним измерением [inner_begin, inner_end)
+typedef struct {
+    RecursiveLU* lu;
+    int inner_begin;
+    int inner_end;
+    int row_begin;
+    int row_end;
+    int col_begin;
+    int col_end;
+} UpdateBlock;
+
+// Узкая панель столбцов [k0, k0 + width) по всем строкам ниже k0
+static void factor_base_panel(RecursiveLU* lu, int k0, int width) {
+    const double EPS = 1e-12;
+    double** a = lu->matrix;
+    int n = lu->size;
+    int panel_end = k0 + width;
+
+    for (int j = k0; j < panel_end; j++) {
+        int max_row = j;
+        double max_val = fabs(a[j][j]);
+
+        for (int row = j + 1; row < n; row++) {
+            double val = fabs(a[row][j]);
+            if (val > max_val) {
+                max_val = val;
+                max_row = row;
+            }
+        }
+
+        if (max_val < EPS) {
+            lu->failed = 1;
+            return;
+        }
+
+        if (max_row != j) {
+            double* tmp_row = a[j];
+            a[j] = a[max_row];
+            a[max_row] = tmp_row;
+            lu->swap_count++;
+        }
+
+        double pivot = a[j][j];
+        const double* pivot_row = a[j];
+
+        for (int row = j + 1; row < n; row++) {
+            double* current = a[row];
+            double factor = current[j] / pivot;
+            current[j] = factor;
+            row_update(current + j + 1, pivot_row + j + 1, factor, panel_end - j - 1);
+        }
+    }
+}
+
+// Половины делятся по большему измерению, столбцы - по границе 8 элементов
+static int split_block(const UpdateBlock* block, UpdateBlock* first, UpdateBlock* second,
+                       int leaf_rows, int leaf_columns) {
+    int rows = block->row_end - block->row_begin;
+    int columns = block->col_end - block->col_begin;
+
+    *first = *block;
+    *second = *block;
+
+    if (columns > leaf_columns && columns >= rows) {
+        int middle = block->col_begin + ((columns / 2 + 7) & ~7);
+        first->col_end = middle;
+        second->col_begin = middle;
+        return 1;
+    }
+    if (rows > leaf_rows) {
+        int middle = block->row_begin + rows / 2;
+        first->row_end = middle;
+        second->row_begin = middle;
+        return 1;
+    }
+    if (columns > leaf_columns) {
+        int middle = block->col_begin + ((columns / 2 + 7) & ~7);
+        first->col_end = middle;
+        second->col_begin = middle;
+        return 1;
+    }
+    return 0;
+}
+
+// A22 -= L21 * U12: листья независимы и выполняются как задачи
+static void gemm_task(void* arg) {
+    UpdateBlock* block = (UpdateBlock*)arg;
+
+    UpdateBlock halves[2];
+    if (split_block(block, &halves[0], &halves[1], UPDATE_LEAF_ROWS, UPDATE_LEAF_COLUMNS)) {
+        TaskGroup group;
+        task_group_init(&group);
+        task_spawn(&group, gemm_task, &halves[1]);
+        gemm_task(&halves[0]);
+        task_wait(&group);
+        return;
+    }
+
+    double** a = block->lu->matrix;
+    int col_begin = block->col_begin;
+    int columns = block->col_end - col_begin;
+
+    for (int row = block->row_begin; row < block->row_end; row++) {
+        double* target = a[row];
+        for (int p = block->inner_begin; p < block->inner_end; p++) {
+            double factor = target[p];
+            if (factor == 0.0) continue;
+            row_update(target + col_begin, a[p] + col_begin, factor, columns);
+        }
+    }
+}
+
+// Полоса столбцов правой половины: TRSM для U12, затем GEMM тех же столбцов.
+// Полосы не зависят друг от друга, поэтому между TRSM и GEMM нет общего барьера
+static void update_columns_task(void* arg) {
+    UpdateBlock* block = (UpdateBlock*)arg;
+    int columns = block->col_end - block->col_begin;
+
+    if (columns > UPDATE_LEAF_COLUMNS) {
+        UpdateBlock halves[2] = {*block, *block};
+        int middle = block->col_begin + ((columns / 2 + 7) & ~7);
+        halves[0].col_end = middle;
+        halves[1].col_begin = middle;
+
+        TaskGroup group;
+        task_group_init(&group);
+        task_spawn(&group, update_columns_task, &halves[1]);
+        update_columns_task(&halves[0]);
+        task_wait(&group);
+        return;
+    }
+
+    double** a = block->lu->matrix;
+    int k0 = block->inner_begin;
+    int k1 = block->inner_end;
+
+    for (int r = k0 + 1; r < k1; r++) {
+        double* target = a[r];
+        for (int p = k0; p < r; p++) {
+            row_update(target + block->col_begin, a[p] + block->col_begin, target[p], columns);
+        }
+    }
+
+    if (block->row_begin < block->row_end) {
+        gemm_task(block);
+    }
+}
+
+static void recursive_lu(RecursiveLU* lu, int k0, int width) {
+    if (lu->failed) return;
+
+    if (width <= RECURSIVE_BASE_COLUMNS) {
+        factor_base_panel(lu, k0, width);
+        return;
+    }
+
+    int left = (width / 2 + 7) & ~7;
+    recursive_lu(lu, k0, left);
+    if (lu->failed) return;
+
+    UpdateBlock update;
+    update.lu = lu;
+    update.inner_begin = k0;
+    update.inner_end = k0 + left;
+    update.row_begin = k0 + left;
+    update.row_end = lu->size;
+    update.col_begin = k0 + left;
+    update.col_end = k0 + width;
+    update_columns_task(&update);
+
+    recursive_lu(lu, k0 + left, width - left);
+}
+
+static void recursive_lu_root(void* arg) {
+    RecursiveLU* lu = (RecursiveLU*)arg;
+    recursive_lu(lu, 0, lu->size);
+}
+
+ScaledDeterminant determinant_parallel_recursive_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return scaled_determinant_zero();
+    }
+
+    int n = matrix->size;
+
+    double** temp = copy_matrix_data_threads(matrix, max_threads);
+    if (!temp) return scaled_determinant_zero();
+
+    RecursiveLU lu;
+    lu.matrix = temp;
+    lu.size = n;
+    lu.swap_count = 0;
+    lu.failed = 0;
+
+    task_scheduler_run(max_threads, recursive_lu_root, &lu);
+
+    if (lu.failed) {
+        free_matrix_data(temp, n);
+        return scaled_determinant_zero();
+    }
+
+    ScaledDeterminant det = scaled_determinant_one();
+    for (int i = 0; i < n; i++) {
+        scaled_determinant_multiply(&det, temp[i][i]);
+    }
+
+    if (lu.swap_count % 2 == 1) {
+        scaled_determinant_negate(&det);
+    }
+
+    free_matrix_data(temp, n);
+
+    return det;
+}
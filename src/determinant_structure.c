@@ -0,0 +1,454 @@
+#include "determinant.h"
+#include "kernels.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Выбор ядра по структуре (-a auto): один параллельный проход собирает по строкам
+// первый и последний ненулевой столбец и число ненулевых, дальше O(N) решений
+
+#define STRUCTURE_LARGE_BLOCK 256
+#define STRUCTURE_SPARSE_DENSITY 0.05
+
+typedef struct {
+    const Matrix* matrix;
+    int* first;
+    int* last;
+    int* nonzeros;
+} StructureScanData;
+
+typedef struct {
+    int lower_bandwidth;
+    int upper_bandwidth;
+    long nonzeros;
+    int zero_row;
+} MatrixStructure;
+
+typedef struct {
+    Matrix** blocks;
+    ScaledDeterminant* results;
+    int count;
+    int next;
+} BlockDiagonalData;
+
+static char structure_route[128] = "";
+
+static void structure_scan_task(void* arg, int thread_index, int thread_count) {
+    StructureScanData* data = (StructureScanData*)arg;
+    int n = data->matrix->size;
+
+    int start_row, end_row;
+    thread_row_range(0, n, thread_index, thread_count, &start_row, &end_row);
+
+    for (int i = start_row; i < end_row; i++) {
+        const double* row = data->matrix->data[i];
+        int first = n;
+        int last = -1;
+        int count = 0;
+        for (int j = 0; j < n; j++) {
+            if (row[j] != 0.0) {
+                if (first == n) first = j;
+                last = j;
+                count++;
+            }
+        }
+        data->first[i] = first;
+        data->last[i] = last;
+        data->nonzeros[i] = count;
+    }
+}
+
+static MatrixStructure summarize_structure(const int* first, const int* last, const int* nonzeros, int n) {
+    MatrixStructure s = {0, 0, 0, 0};
+    for (int i = 0; i < n; i++) {
+        if (nonzeros[i] == 0) {
+            s.zero_row = 1;
+            continue;
+        }
+        if (i - first[i] > s.lower_bandwidth) s.lower_bandwidth = i - first[i];
+        if (last[i] - i > s.upper_bandwidth) s.upper_bandwidth = last[i] - i;
+        s.nonzeros += nonzeros[i];
+    }
+    return s;
+}
+
+static ScaledDeterminant diagonal_product(const Matrix* matrix) {
+    ScaledDeterminant det = scaled_determinant_one();
+    for (int i = 0; i < matrix->size; i++) {
+        scaled_determinant_multiply(&det, matrix->data[i][i]);
+    }
+    return det;
+}
+
+// Ленточное LU с выбором опорного: после перестановок верхняя полоса растет до kl + ku
+static ScaledDeterminant band_determinant(const Matrix* matrix, int kl, int ku) {
+    const double EPS = 1e-12;
+    int n = matrix->size;
+
+    double** a = copy_matrix_data(matrix);
+    if (!a) return scaled_determinant_zero();
+
+    ScaledDeterminant det = scaled_determinant_one();
+    int swap_count = 0;
+
+    for (int col = 0; col < n; col++) {
+        int last_row = col + kl < n ? col + kl : n - 1;
+        int last_col = col + kl + ku < n ? col + kl + ku : n - 1;
+
+        int max_row = col;
+        double max_val = fabs(a[col][col]);
+        for (int row = col + 1; row <= last_row; row++) {
+            double val = fabs(a[row][col]);
+            if (val > max_val) {
+                max_val = val;
+                max_row = row;
+            }
+        }
+
+        if (max_val < EPS) {
+            free_matrix_data(a, n);
+            return scaled_determinant_zero();
+        }
+
+        if (max_row != col) {
+            double* tmp_row = a[col];
+            a[col] = a[max_row];
+            a[max_row] = tmp_row;
+            swap_count++;
+        }
+
+        double pivot = a[col][col];
+        for (int row = col + 1; row <= last_row; row++) {
+            double factor = a[row][col] / pivot;
+            if (factor == 0.0) continue;
+            row_update(a[row] + col + 1, a[col] + col + 1, factor, last_col - col);
+        }
+
+        scaled_determinant_multiply(&det, pivot);
+    }
+
+    if (swap_count % 2 == 1) {
+        scaled_determinant_negate(&det);
+    }
+
+    free_matrix_data(a, n);
+    return det;
+}
+
+// Обратный алгоритм Катхилла-Макки по симметризованному шаблону A + A^T
+static int* reverse_cuthill_mckee(const Matrix* matrix, long nonzeros) {
+    int n = matrix->size;
+
+    int* degree = (int*)calloc(n, sizeof(int));
+    int* offsets = (int*)malloc((n + 1) * sizeof(int));
+    int* fill = (int*)malloc(n * sizeof(int));
+    int* neighbours = (int*)malloc(2 * nonzeros * sizeof(int));
+    int* order = (int*)malloc(n * sizeof(int));
+    char* visited = (char*)calloc(n, 1);
+
+    if (!degree || !offsets || !fill || !neighbours || !order || !visited) {
+        free(degree);
+        free(offsets);
+        free(fill);
+        free(neighbours);
+        free(order);
+        free(visited);
+        return NULL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && (matrix->data[i][j] != 0.0 || matrix->data[j][i] != 0.0)) {
+                degree[i]++;
+            }
+        }
+    }
+    offsets[0] = 0;
+    for (int i = 0; i < n; i++) {
+        offsets[i + 1] = offsets[i] + degree[i];
+        fill[i] = offsets[i];
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && (matrix->data[i][j] != 0.0 || matrix->data[j][i] != 0.0)) {
+                neighbours[fill[i]++] = j;
+            }
+        }
+    }
+
+    int head = 0;
+    int tail = 0;
+    while (tail < n) {
+        // Новая компонента связности начинается с вершины минимальной степени
+        int start = -1;
+        for (int i = 0; i < n; i++) {
+            if (!visited[i] && (start < 0 || degree[i] < degree[start])) start = i;
+        }
+        visited[start] = 1;
+        order[tail++] = start;
+
+        while (head < tail) {
+            int node = order[head++];
+            int begin = tail;
+            for (int k = offsets[node]; k < offsets[node + 1]; k++) {
+                int next = neighbours[k];
+                if (!visited[next]) {
+                    visited[next] = 1;
+                    order[tail++] = next;
+                }
+            }
+            // Соседи в порядке возрастания степени (вставками: списки короткие)
+            for (int x = begin + 1; x < tail; x++) {
+                int node_x = order[x];
+                int y = x - 1;
+                while (y >= begin && degree[order[y]] > degree[node_x]) {
+                    order[y + 1] = order[y];
+                    y--;
+                }
+                order[y + 1] = node_x;
+            }
+        }
+    }
+
+    for (int i = 0; i < n / 2; i++) {
+        int tmp = order[i];
+        order[i] = order[n - 1 - i];
+        order[n - 1 - i] = tmp;
+    }
+
+    free(degree);
+    free(offsets);
+    free(fill);
+    free(neighbours);
+    free(visited);
+    return order;
+}
+
+// P A P^T: симметричная перестановка не меняет детерминант
+static Matrix* permute_symmetric(const Matrix* matrix, const int* order) {
+    int n = matrix->size;
+    Matrix* result = matrix_create(n);
+    if (!result) return NULL;
+
+    for (int i = 0; i < n; i++) {
+        const double* source = matrix->data[order[i]];
+        double* target = result->data[i];
+        for (int j = 0; j < n; j++) {
+            target[j] = source[order[j]];
+        }
+    }
+    return result;
+}
+
+static void bandwidths(const Matrix* matrix, int* kl, int* ku) {
+    int n = matrix->size;
+    *kl = 0;
+    *ku = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (matrix->data[i][j] == 0.0) continue;
+            if (i - j > *kl) *kl = i - j;
+            if (j - i > *ku) *ku = j - i;
+        }
+    }
+}
+
+static int band_is_narrow(int n, int kl, int ku) {
+    return (long)(kl + ku + 1) * 4 <= n;
+}
+
+static ScaledDeterminant structured_determinant(const Matrix* matrix, int max_threads, int describe);
+
+static void block_diagonal_task(void* arg, int thread_index, int thread_count) {
+    BlockDiagonalData* data = (BlockDiagonalData*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    for (;;) {
+        int index = __atomic_fetch_add(&data->next, 1, __ATOMIC_RELAXED);
+        if (index >= data->count) break;
+        // Внутри задачи пула - только последовательный путь: ни пула, ни вложенного разбора структуры
+        if (data->blocks[index]->size < STRUCTURE_LARGE_BLOCK) {
+            data->results[index] = determinant_sequential_scaled(data->blocks[index]);
+        }
+    }
+}
+
+// Границы k, через которые не проходит ни один ненулевой: строки < k не задевают столбцы >= k и наоборот
+static int find_block_boundaries(const int* first, const int* last, int n, int* starts) {
+    int count = 0;
+    int max_last = -1;
+    starts[count++] = 0;
+
+    int* suffix_min_first = (int*)malloc((n + 1) * sizeof(int));
+    if (!suffix_min_first) return 1;
+    suffix_min_first[n] = n;
+    for (int i = n - 1; i >= 0; i--) {
+        suffix_min_first[i] = first[i] < suffix_min_first[i + 1] ? first[i] : suffix_min_first[i + 1];
+    }
+
+    for (int k = 1; k < n; k++) {
+        if (last[k - 1] > max_last) max_last = last[k - 1];
+        if (max_last < k && suffix_min_first[k] >= k) {
+            starts[count++] = k;
+        }
+    }
+
+    free(suffix_min_first);
+    return count;
+}
+
+static ScaledDeterminant block_diagonal_determinant(const Matrix* matrix, const int* starts, int count, int max_threads) {
+    int n = matrix->size;
+    Matrix** blocks = (Matrix**)calloc(count, sizeof(Matrix*));
+    ScaledDeterminant* results = (ScaledDeterminant*)malloc(count * sizeof(ScaledDeterminant));
+    ScaledDeterminant det = scaled_determinant_zero();
+
+    int ok = blocks && results;
+    for (int b = 0; ok && b < count; b++) {
+        int begin = starts[b];
+        int size = (b + 1 < count ? starts[b + 1] : n) - begin;
+        blocks[b] = matrix_create(size);
+        if (!blocks[b]) {
+            ok = 0;
+            break;
+        }
+        for (int i = 0; i < size; i++) {
+            memcpy(blocks[b]->data[i], matrix->data[begin + i] + begin, size * sizeof(double));
+        }
+    }
+
+    if (ok) {
+        // Мелкие блоки параллельно между собой, крупные - по очереди всеми потоками
+        BlockDiagonalData data;
+        data.blocks = blocks;
+        data.results = results;
+        data.count = count;
+        data.next = 0;
+        thread_pool_run(thread_pool_shared(max_threads), max_threads, block_diagonal_task, &data);
+
+        det = scaled_determinant_one();
+        for (int b = 0; b < count; b++) {
+            if (blocks[b]->size >= STRUCTURE_LARGE_BLOCK) {
+                results[b] = structured_determinant(blocks[b], max_threads, 0);
+            }
+            // Вырожденный блок - весь определитель ноль, порядок дальше не копим
+            if (results[b].mantissa == 0.0) {
+                det = scaled_determinant_zero();
+                break;
+            }
+            scaled_determinant_multiply(&det, results[b].mantissa);
+            det.exponent += results[b].exponent;
+        }
+    }
+
+    for (int b = 0; blocks && b < count; b++) {
+        matrix_free(blocks[b]);
+    }
+    free(blocks);
+    free(results);
+    return det;
+}
+
+static ScaledDeterminant structured_determinant(const Matrix* matrix, int max_threads, int describe) {
+    int n = matrix->size;
+
+    int* first = (int*)malloc(n * sizeof(int));
+    int* last = (int*)malloc(n * sizeof(int));
+    int* nonzeros = (int*)malloc(n * sizeof(int));
+    int* starts = (int*)malloc(n * sizeof(int));
+    if (!first || !last || !nonzeros || !starts) {
+        free(first);
+        free(last);
+        free(nonzeros);
+        free(starts);
+        return determinant_parallel_block_scaled(matrix, max_threads);
+    }
+
+    StructureScanData scan;
+    scan.matrix = matrix;
+    scan.first = first;
+    scan.last = last;
+    scan.nonzeros = nonzeros;
+    thread_pool_run(thread_pool_shared(max_threads), max_threads, structure_scan_task, &scan);
+
+    MatrixStructure s = summarize_structure(first, last, nonzeros, n);
+    int block_count = s.zero_row ? 0 : find_block_boundaries(first, last, n, starts);
+    ScaledDeterminant det;
+
+    if (s.zero_row) {
+        if (describe) snprintf(structure_route, sizeof(structure_route), "нулевая строка");
+        det = scaled_determinant_zero();
+    } else if (s.lower_bandwidth == 0 || s.upper_bandwidth == 0) {
+        if (describe) {
+            snprintf(structure_route, sizeof(structure_route), "%s, произведение диагонали",
+                     s.lower_bandwidth == s.upper_bandwidth ? "диагональная" : "треугольная");
+        }
+        det = diagonal_product(matrix);
+    } else if (block_count > 1) {
+        if (describe) snprintf(structure_route, sizeof(structure_route), "блочно-диагональная, блоков: %d", block_count);
+        det = block_diagonal_determinant(matrix, starts, block_count, max_threads);
+    } else if (band_is_narrow(n, s.lower_bandwidth, s.upper_bandwidth)) {
+        if (describe) {
+            snprintf(structure_route, sizeof(structure_route), "ленточная (kl = %d, ku = %d)",
+                     s.lower_bandwidth, s.upper_bandwidth);
+        }
+        det = band_determinant(matrix, s.lower_bandwidth, s.upper_bandwidth);
+    } else {
+        Matrix* reordered = NULL;
+        int kl = 0, ku = 0;
+
+        // rcm-band: разреженную матрицу RCM переупорядочивает в узкую ленту для ленточного LU
+        int sparse = (double)s.nonzeros < STRUCTURE_SPARSE_DENSITY * n * n;
+        if (sparse) {
+            int* order = reverse_cuthill_mckee(matrix, s.nonzeros);
+            if (order) {
+                reordered = permute_symmetric(matrix, order);
+                free(order);
+            }
+            if (reordered) {
+                bandwidths(reordered, &kl, &ku);
+                if (!band_is_narrow(n, kl, ku)) {
+                    matrix_free(reordered);
+                    reordered = NULL;
+                }
+            }
+        }
+
+        if (reordered) {
+            if (describe) {
+                snprintf(structure_route, sizeof(structure_route),
+                         "rcm-band: разреженная (%.2f%%), RCM -> лента kl = %d, ku = %d",
+                         100.0 * s.nonzeros / ((double)n * n), kl, ku);
+            }
+            det = band_determinant(reordered, kl, ku);
+            matrix_free(reordered);
+        } else {
+            // Разреженного LU нет: если RCM не сузил ленту, считаем плотным блочным LU
+            if (describe) {
+                snprintf(structure_route, sizeof(structure_route), "%s, блочное LU",
+                         sparse ? "разреженная, RCM не сузил ленту" : "плотная");
+            }
+            det = determinant_parallel_block_scaled(matrix, max_threads);
+        }
+    }
+
+    free(first);
+    free(last);
+    free(nonzeros);
+    free(starts);
+    return det;
+}
+
+ScaledDeterminant determinant_structured_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return scaled_determinant_zero();
+    }
+    return structured_determinant(matrix, max_threads, 1);
+}
+
+const char* determinant_structure_route(void) {
+    return structure_route;
+}
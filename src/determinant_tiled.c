@@ -0,0 +1,338 @@
+#include "determinant.h"
+#include "kernels.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+// Тайловое LU с графом зависимостей: вместо общего барьера на каждом шаге
+// задача запускается, как только готовы ее входные тайлы. Панель k + 1 факторизуется,
+// пока обновления шага k для дальних столбцов еще идут (look-ahead).
+// Строки переставляются поэлементно внутри полосы столбцов, поэтому полосы
+// разных шагов можно обрабатывать одновременно
+
+#define TILE_SIZE 64
+
+typedef enum {
+    TILE_PANEL,
+    TILE_SWAP_TRSM,
+    TILE_GEMM
+} TileTaskType;
+
+typedef struct {
+    TileTaskType type;
+    int step;
+    int column;
+    int row_tile;
+} TileTask;
+
+typedef struct {
+    double** matrix;
+    int size;
+    int tiles;
+    int* pivots;
+    int swap_count;
+    int failed;
+
+    // Осталось зависимостей у SWAP_TRSM(step, column): панель step и шаг step - 1 для столбца
+    int* trsm_dependencies;
+    // Незавершенные GEMM текущего шага в полосе столбца (у полосы в работе не больше одного шага)
+    int* gemm_left;
+
+    TileTask* ready;
+    int ready_count;
+    int remaining;
+    pthread_mutex_t mutex;
+    pthread_cond_t ready_cond;
+} TiledLU;
+
+static int tile_begin(int tile) {
+    return tile * TILE_SIZE;
+}
+
+static int tile_end(const TiledLU* lu, int tile) {
+    int end = (tile + 1) * TILE_SIZE;
+    return end < lu->size ? end : lu->size;
+}
+
+// Чем меньше, тем срочнее: сначала панели и то, что быстрее приводит к следующей панели
+static int task_precedes(const TileTask* x, const TileTask* y) {
+    int x_key = x->column * 2 + (x->type != TILE_PANEL);
+    int y_key = y->column * 2 + (y->type != TILE_PANEL);
+    if (x_key != y_key) return x_key < y_key;
+    if (x->step != y->step) return x->step < y->step;
+    return x->row_tile < y->row_tile;
+}
+
+static void push_ready(TiledLU* lu, TileTask task) {
+    int i = lu->ready_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!task_precedes(&task, &lu->ready[parent])) break;
+        lu->ready[i] = lu->ready[parent];
+        i = parent;
+    }
+    lu->ready[i] = task;
+    pthread_cond_signal(&lu->ready_cond);
+}
+
+static TileTask pop_ready(TiledLU* lu) {
+    TileTask top = lu->ready[0];
+    TileTask last = lu->ready[--lu->ready_count];
+
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= lu->ready_count) break;
+        if (child + 1 < lu->ready_count && task_precedes(&lu->ready[child + 1], &lu->ready[child])) {
+            child++;
+        }
+        if (!task_precedes(&lu->ready[child], &last)) break;
+        lu->ready[i] = lu->ready[child];
+        i = child;
+    }
+    if (lu->ready_count > 0) {
+        lu->ready[i] = last;
+    }
+    return top;
+}
+
+static void swap_row_segments(double* x, double* y, int begin, int end) {
+    for (int c = begin; c < end; c++) {
+        double tmp = x[c];
+        x[c] = y[c];
+        y[c] = tmp;
+    }
+}
+
+// Панель k: все строки ниже k * TILE_SIZE, перестановки только внутри своих столбцов
+static void run_panel(TiledLU* lu, int k) {
+    const double EPS = 1e-12;
+    double** a = lu->matrix;
+    int n = lu->size;
+    int c0 = tile_begin(k);
+    int c1 = tile_end(lu, k);
+
+    for (int j = c0; j < c1; j++) {
+        int max_row = j;
+        double max_val = fabs(a[j][j]);
+
+        for (int row = j + 1; row < n; row++) {
+            double val = fabs(a[row][j]);
+            if (val > max_val) {
+                max_val = val;
+                max_row = row;
+            }
+        }
+
+        if (max_val < EPS) {
+            __atomic_store_n(&lu->failed, 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        lu->pivots[j] = max_row;
+        if (max_row != j) {
+            swap_row_segments(a[j], a[max_row], c0, c1);
+            lu->swap_count++;
+        }
+
+        double pivot = a[j][j];
+        const double* pivot_row = a[j];
+
+        for (int row = j + 1; row < n; row++) {
+            double* current = a[row];
+            double factor = current[j] / pivot;
+            current[j] = factor;
+            row_update(current + j + 1, pivot_row + j + 1, factor, c1 - j - 1);
+        }
+    }
+}
+
+// Перестановки панели k в полосе j и U(k, j) = L(k, k)^-1 A(k, j)
+static void run_swap_trsm(TiledLU* lu, int k, int j) {
+    double** a = lu->matrix;
+    int r0 = tile_begin(k);
+    int r1 = tile_end(lu, k);
+    int c0 = tile_begin(j);
+    int c1 = tile_end(lu, j);
+
+    for (int r = r0; r < r1; r++) {
+        if (lu->pivots[r] != r) {
+            swap_row_segments(a[r], a[lu->pivots[r]], c0, c1);
+        }
+    }
+
+    for (int r = r0 + 1; r < r1; r++) {
+        double* target = a[r];
+        for (int p = r0; p < r; p++) {
+            row_update(target + c0, a[p] + c0, target[p], c1 - c0);
+        }
+    }
+}
+
+// A(i, j) -= L(i, k) * U(k, j)
+static void run_gemm(TiledLU* lu, int k, int j, int i) {
+    double** a = lu->matrix;
+    int p0 = tile_begin(k);
+    int p1 = tile_end(lu, k);
+    int c0 = tile_begin(j);
+    int c1 = tile_end(lu, j);
+
+    for (int row = tile_begin(i); row < tile_end(lu, i); row++) {
+        double* target = a[row];
+        for (int p = p0; p < p1; p++) {
+            double factor = target[p];
+            if (factor == 0.0) continue;
+            row_update(target + c0, a[p] + c0, factor, c1 - c0);
+        }
+    }
+}
+
+static void execute_tile_task(TiledLU* lu, const TileTask* task) {
+    // После вырожденной панели задачи только проходят по графу, чтобы все потоки завершились
+    if (__atomic_load_n(&lu->failed, __ATOMIC_RELAXED)) return;
+
+    switch (task->type) {
+        case TILE_PANEL:
+            run_panel(lu, task->step);
+            break;
+        case TILE_SWAP_TRSM:
+            run_swap_trsm(lu, task->step, task->column);
+            break;
+        case TILE_GEMM:
+            run_gemm(lu, task->step, task->column, task->row_tile);
+            break;
+    }
+}
+
+// Вызывается под mutex: снимает зависимости и ставит освободившиеся задачи в очередь
+static void complete_tile_task(TiledLU* lu, const TileTask* task) {
+    int tiles = lu->tiles;
+    int k = task->step;
+
+    if (task->type == TILE_PANEL) {
+        for (int j = k + 1; j < tiles; j++) {
+            if (--lu->trsm_dependencies[k * tiles + j] == 0) {
+                TileTask next = {TILE_SWAP_TRSM, k, j, k};
+                push_ready(lu, next);
+            }
+        }
+    } else if (task->type == TILE_SWAP_TRSM) {
+        int j = task->column;
+        lu->gemm_left[j] = tiles - k - 1;
+        for (int i = k + 1; i < tiles; i++) {
+            TileTask next = {TILE_GEMM, k, j, i};
+            push_ready(lu, next);
+        }
+    } else {
+        int j = task->column;
+        if (--lu->gemm_left[j] == 0) {
+            if (j == k + 1) {
+                TileTask next = {TILE_PANEL, k + 1, k + 1, k + 1};
+                push_ready(lu, next);
+            } else if (--lu->trsm_dependencies[(k + 1) * tiles + j] == 0) {
+                TileTask next = {TILE_SWAP_TRSM, k + 1, j, k + 1};
+                push_ready(lu, next);
+            }
+        }
+    }
+
+    if (--lu->remaining == 0) {
+        pthread_cond_broadcast(&lu->ready_cond);
+    }
+}
+
+static void tiled_worker_task(void* arg, int thread_index, int thread_count) {
+    TiledLU* lu = (TiledLU*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    pthread_mutex_lock(&lu->mutex);
+    for (;;) {
+        while (lu->ready_count == 0 && lu->remaining > 0) {
+            pthread_cond_wait(&lu->ready_cond, &lu->mutex);
+        }
+        if (lu->remaining == 0) break;
+
+        TileTask task = pop_ready(lu);
+        pthread_mutex_unlock(&lu->mutex);
+
+        execute_tile_task(lu, &task);
+
+        pthread_mutex_lock(&lu->mutex);
+        complete_tile_task(lu, &task);
+    }
+    pthread_mutex_unlock(&lu->mutex);
+}
+
+ScaledDeterminant determinant_parallel_tiled_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return scaled_determinant_zero();
+    }
+
+    int n = matrix->size;
+    int tiles = (n + TILE_SIZE - 1) / TILE_SIZE;
+
+    double** temp = copy_matrix_data_threads(matrix, max_threads);
+    if (!temp) return scaled_determinant_zero();
+
+    TiledLU lu;
+    lu.matrix = temp;
+    lu.size = n;
+    lu.tiles = tiles;
+    lu.swap_count = 0;
+    lu.failed = 0;
+    lu.ready_count = 0;
+    lu.pivots = (int*)malloc(n * sizeof(int));
+    lu.trsm_dependencies = (int*)malloc(tiles * tiles * sizeof(int));
+    lu.gemm_left = (int*)calloc(tiles, sizeof(int));
+    lu.ready = (TileTask*)malloc((tiles * tiles + tiles + 1) * sizeof(TileTask));
+
+    if (!lu.pivots || !lu.trsm_dependencies || !lu.gemm_left || !lu.ready) {
+        free(lu.pivots);
+        free(lu.trsm_dependencies);
+        free(lu.gemm_left);
+        free(lu.ready);
+        free_matrix_data(temp, n);
+        return determinant_parallel_block_scaled(matrix, max_threads);
+    }
+
+    // Панели + SWAP_TRSM + GEMM всех шагов
+    lu.remaining = 0;
+    for (int k = 0; k < tiles; k++) {
+        int below = tiles - k - 1;
+        lu.remaining += 1 + below + below * below;
+        for (int j = k + 1; j < tiles; j++) {
+            lu.trsm_dependencies[k * tiles + j] = k == 0 ? 1 : 2;
+        }
+    }
+
+    pthread_mutex_init(&lu.mutex, NULL);
+    pthread_cond_init(&lu.ready_cond, NULL);
+
+    TileTask first = {TILE_PANEL, 0, 0, 0};
+    push_ready(&lu, first);
+
+    thread_pool_run(thread_pool_shared(max_threads), max_threads, tiled_worker_task, &lu);
+
+    pthread_mutex_destroy(&lu.mutex);
+    pthread_cond_destroy(&lu.ready_cond);
+
+    ScaledDeterminant det = scaled_determinant_zero();
+    if (!lu.failed) {
+        det = scaled_determinant_one();
+        for (int i = 0; i < n; i++) {
+            scaled_determinant_multiply(&det, temp[i][i]);
+        }
+        if (lu.swap_count % 2 == 1) {
+            scaled_determinant_negate(&det);
+        }
+    }
+
+    free(lu.pivots);
+    free(lu.trsm_dependencies);
+    free(lu.gemm_left);
+    free(lu.ready);
+    free_matrix_data(temp, n);
+
+    return det;
+}
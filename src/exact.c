@@ -0,0 +1,245 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "exact.h"
+#include "thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define EXACT_MAX_VALUE 9007199254740992.0
+
+typedef struct {
+    BigInt** matrix;
+    const BigInt* previous;
+    int size;
+    int pivot_row;
+    BigInt* scratch;
+    int failed;
+} BareissStepData;
+
+int matrix_is_integer(const Matrix* matrix) {
+    if (!matrix_is_valid(matrix)) return 0;
+
+    for (int i = 0; i < matrix->size; i++) {
+        for (int j = 0; j < matrix->size; j++) {
+            double value = matrix->data[i][j];
+            if (value != floor(value) || fabs(value) > EXACT_MAX_VALUE) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// a[i][j] = (a[i][j] * a[k][k] - a[i][k] * a[k][j]) / p, деление всегда нацело
+static void bareiss_rows_task(void* arg, int thread_index, int thread_count) {
+    BareissStepData* data = (BareissStepData*)arg;
+
+    BigInt** matrix = data->matrix;
+    int size = data->size;
+    int k = data->pivot_row;
+    const BigInt* pivot = &matrix[k][k];
+    BigInt* product = &data->scratch[thread_index * 2];
+    BigInt* correction = &data->scratch[thread_index * 2 + 1];
+
+    int start_row, end_row;
+    thread_row_range(k + 1, size, thread_index, thread_count, &start_row, &end_row);
+
+    for (int i = start_row; i < end_row; i++) {
+        const BigInt* factor = &matrix[i][k];
+
+        for (int j = k + 1; j < size; j++) {
+            int ok = bigint_mul(product, &matrix[i][j], pivot) &&
+                     bigint_mul(correction, factor, &matrix[k][j]) &&
+                     bigint_sub(product, product, correction);
+
+            if (ok && data->previous) {
+                ok = bigint_div(&matrix[i][j], product, data->previous);
+            } else if (ok) {
+                bigint_swap(&matrix[i][j], product);
+            }
+
+            if (!ok) {
+                data->failed = 1;
+                return;
+            }
+        }
+    }
+}
+
+static void free_bigint_matrix(BigInt* cells, BigInt** rows, int count) {
+    if (cells) {
+        for (int i = 0; i < count; i++) {
+            bigint_free(&cells[i]);
+        }
+    }
+    free(cells);
+    free(rows);
+}
+
+int determinant_bareiss(const Matrix* matrix, int max_threads, BigInt* result) {
+    if (!matrix_is_integer(matrix)) {
+        return 0;
+    }
+
+    int n = matrix->size;
+    int cell_count = n * n;
+    int thread_count = max_threads > 0 ? max_threads : 1;
+
+    BigInt* cells = (BigInt*)malloc(cell_count * sizeof(BigInt));
+    BigInt** rows = (BigInt**)malloc(n * sizeof(BigInt*));
+    BigInt* scratch = (BigInt*)malloc(thread_count * 2 * sizeof(BigInt));
+    if (!cells || !rows || !scratch) {
+        free(cells);
+        free(rows);
+        free(scratch);
+        return 0;
+    }
+
+    for (int i = 0; i < thread_count * 2; i++) {
+        bigint_init(&scratch[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        rows[i] = cells + i * n;
+        for (int j = 0; j < n; j++) {
+            bigint_init(&rows[i][j]);
+            if (!bigint_set_int64(&rows[i][j], (int64_t)matrix->data[i][j])) ok = 0;
+        }
+    }
+
+    ThreadPool* pool = thread_pool_shared(thread_count);
+    int negative = 0;
+    int singular = 0;
+
+    BareissStepData step;
+    step.matrix = rows;
+    step.previous = NULL;
+    step.size = n;
+    step.scratch = scratch;
+    step.failed = 0;
+
+    for (int k = 0; ok && k < n - 1; k++) {
+        // Для точной арифметики годится любой ненулевой опорный элемент
+        if (bigint_is_zero(&rows[k][k])) {
+            int swap_row = -1;
+            for (int i = k + 1; i < n; i++) {
+                if (!bigint_is_zero(&rows[i][k])) {
+                    swap_row = i;
+                    break;
+                }
+            }
+            if (swap_row < 0) {
+                singular = 1;
+                break;
+            }
+            BigInt* tmp_row = rows[k];
+            rows[k] = rows[swap_row];
+            rows[swap_row] = tmp_row;
+            negative = !negative;
+        }
+
+        int rows_to_process = n - k - 1;
+        step.pivot_row = k;
+        thread_pool_run(pool, rows_to_process < thread_count ? rows_to_process : thread_count,
+                        bareiss_rows_task, &step);
+        ok = !step.failed;
+
+        step.previous = &rows[k][k];
+    }
+
+    if (ok) {
+        if (singular) {
+            ok = bigint_set_int64(result, 0);
+        } else {
+            ok = bigint_copy(result, &rows[n - 1][n - 1]);
+            if (negative) result->sign = -result->sign;
+        }
+    }
+
+    for (int i = 0; i < thread_count * 2; i++) {
+        bigint_free(&scratch[i]);
+    }
+    free(scratch);
+    free_bigint_matrix(cells, rows, cell_count);
+
+    return ok;
+}
+
+ScaledDeterminant bigint_to_scaled_determinant(const BigInt* x) {
+    ScaledDeterminant det = scaled_determinant_zero();
+    if (x->sign == 0) return det;
+
+    // Старших трех разрядов хватает для мантиссы double
+    double top = 0.0;
+    int used = x->length < 3 ? x->length : 3;
+    for (int i = 0; i < used; i++) {
+        top = top * 4294967296.0 + x->limbs[x->length - 1 - i];
+    }
+
+    int exponent;
+    det.mantissa = frexp(top, &exponent) * x->sign;
+    det.exponent = exponent + 32L * (x->length - used);
+    return det;
+}
+
+ScaledDeterminant determinant_bareiss_scaled(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_integer(matrix)) {
+        return determinant_parallel_scaled(matrix, max_threads);
+    }
+
+    BigInt det;
+    bigint_init(&det);
+    ScaledDeterminant scaled = scaled_determinant_zero();
+    if (determinant_bareiss(matrix, max_threads, &det)) {
+        scaled = bigint_to_scaled_determinant(&det);
+    }
+    bigint_free(&det);
+    return scaled;
+}
+
+void print_exact_determinant(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_integer(matrix)) {
+        printf("Точный детерминант: матрица не целочисленная, точный режим недоступен\n");
+        return;
+    }
+
+    BigInt det;
+    bigint_init(&det);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    DeterminantFunction selected = determinant_get_algorithm()->function;
+    int modular = selected == determinant_modular_scaled;
+    int laplace = selected == determinant_laplace_scaled && determinant_laplace_exact(matrix, max_threads, &det);
+    int primes_used = 0;
+    int ok = laplace || (modular ? determinant_modular(matrix, max_threads, &det, &primes_used)
+                                 : determinant_bareiss(matrix, max_threads, &det));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    char* text = ok ? bigint_to_string(&det) : NULL;
+    if (!text) {
+        printf("Ошибка точного вычисления детерминанта\n");
+        bigint_free(&det);
+        return;
+    }
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    int digits = (int)strlen(text) - (det.sign < 0 ? 1 : 0);
+
+    printf("Точный детерминант: %s\n", text);
+    printf("Цифр: %d, знак: %d, ln|det|: %.9f\n", digits, det.sign, bigint_log_abs(&det));
+    if (laplace) {
+        printf("Время (Лаплас): %.9f сек (%.3f мс)\n", elapsed, elapsed * 1000);
+    } else if (modular) {
+        printf("Время (модулярно, простых: %d): %.9f сек (%.3f мс)\n", primes_used, elapsed, elapsed * 1000);
+    } else {
+        printf("Время (Барейс): %.9f сек (%.3f мс)\n", elapsed, elapsed * 1000);
+    }
+
+    free(text);
+    bigint_free(&det);
+}
@@ -0,0 +1,27 @@
+#ifndef EXACT_H
+#define EXACT_H
+
+#include "matrix.h"
+#include "bigint.h"
+#include "determinant.h"
+
+// Все элементы целые и точно представимы в double (|x| <= 2^53)
+int matrix_is_integer(const Matrix* matrix);
+
+// Точный детерминант целочисленной матрицы без дробей (алгоритм Барейса).
+// Строки каждого шага обновляются параллельно. Возвращает 0 при ошибке
+int determinant_bareiss(const Matrix* matrix, int max_threads, BigInt* result);
+
+// Точный детерминант по модулям 62-битных простых (по простому на поток) и КТО.
+// Простых берется столько, чтобы покрыть оценку Адамара. Возвращает 0 при ошибке
+int determinant_modular(const Matrix* matrix, int max_threads, BigInt* result, int* primes_used);
+
+// Точное разложение Лапласа в __int128: целочисленная матрица N <= 24 с оценкой Адамара < 2^120
+int determinant_laplace_exact(const Matrix* matrix, int max_threads, BigInt* result);
+
+ScaledDeterminant bigint_to_scaled_determinant(const BigInt* x);
+
+// Печать точного результата рядом с приближенным (--exact): модулярно при -a modular, Лапласом при -a laplace, иначе Барейсом
+void print_exact_determinant(const Matrix* matrix, int max_threads);
+
+#endif
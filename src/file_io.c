@@ -1,81 +1,763 @@
+#define _DEFAULT_SOURCE
 #include "file_io.h"
+#include "thread_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PARALLEL_PARSE_MIN_BYTES (1 << 20)
+#define MAX_TOKEN_LENGTH 128
+#define SAVE_ROUND_BYTES (4 << 20)
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    size_t first_index;
+    size_t count;
+    size_t failed_index;
+    int failed;
+} ParseChunk;
+
+typedef struct {
+    ParseChunk* chunks;
+    int chunk_count;
+    Matrix* matrix;
+    size_t total;
+} ParallelParseData;
+
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+    off_t offset;
+    int failed;             // errno записи или ENOMEM
+} SaveChunk;
+
+typedef struct {
+    const Matrix* matrix;
+    SaveChunk* chunks;
+    int chunk_count;
+    int start_row;
+    int end_row;
+    int fd;
+} ParallelSaveData;
+
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline int is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static const char* skip_spaces(const char* p, const char* end) {
+    while (p < end && is_space(*p)) p++;
+    return p;
+}
+
+// Быстрый путь для целых и десятичных литералов (не более 15 значащих цифр - результат
+// точно округлен), остальное (экспонента, inf, nan, длинные числа) уходит в strtod
+static const char* parse_number(const char* p, const char* end, double* out) {
+    const char* token_end = p;
+    while (token_end < end && !is_space(*token_end)) token_end++;
+    if (token_end == p) return NULL;
+
+    const char* q = p;
+    int negative = 0;
+    if (*q == '-' || *q == '+') {
+        negative = (*q == '-');
+        q++;
+    }
+
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    int any_digit = 0;
+
+    while (q < token_end && *q == '0') {
+        q++;
+        any_digit = 1;
+    }
+    while (q < token_end && *q >= '0' && *q <= '9') {
+        mantissa = mantissa * 10 + (unsigned long long)(*q - '0');
+        digits++;
+        any_digit = 1;
+        q++;
+    }
+    if (q < token_end && *q == '.') {
+        q++;
+        while (q < token_end && *q >= '0' && *q <= '9') {
+            if (digits > 0 || *q != '0') {
+                digits++;
+            }
+            mantissa = mantissa * 10 + (unsigned long long)(*q - '0');
+            fraction_digits++;
+            any_digit = 1;
+            q++;
+            if (digits > 15 || fraction_digits > 22) break;
+        }
+    }
+
+    if (q == token_end && any_digit && digits <= 15 && fraction_digits <= 22) {
+        double value = (double)mantissa / powers_of_ten[fraction_digits];
+        *out = negative ? -value : value;
+        return token_end;
+    }
+
+    size_t length = (size_t)(token_end - p);
+    if (length >= MAX_TOKEN_LENGTH) return NULL;
+
+    char token[MAX_TOKEN_LENGTH];
+    memcpy(token, p, length);
+    token[length] = '\0';
+
+    char* parsed_end = NULL;
+    double value = strtod(token, &parsed_end);
+    if (parsed_end != token + length) return NULL;
+
+    *out = value;
+    return token_end;
+}
+
+// Разбирает count чисел, начиная с элемента first_index, в строки матрицы
+static const char* parse_values(const char* p, const char* end, Matrix* matrix,
+                                size_t first_index, size_t count, size_t* failed_index) {
+    int n = matrix->size;
+    int row = (int)(first_index / n);
+    int col = (int)(first_index % n);
+    double* target = matrix->values + (size_t)row * matrix->stride;
+
+    for (size_t k = 0; k < count; k++) {
+        p = skip_spaces(p, end);
+        const char* next = (p < end) ? parse_number(p, end, &target[col]) : NULL;
+        if (!next) {
+            *failed_index = first_index + k;
+            return NULL;
+        }
+        p = next;
+
+        if (++col == n) {
+            col = 0;
+            target += matrix->stride;
+        }
+    }
+
+    return p;
+}
+
+static size_t count_tokens(const char* p, const char* end) {
+    size_t count = 0;
+    int in_token = 0;
+    for (; p < end; p++) {
+        int space = is_space(*p);
+        count += (!space && !in_token);
+        in_token = !space;
+    }
+    return count;
+}
+
+// Кусков max_threads, а потоков в запуске может оказаться меньше (вложенный вызов, урезанный пул)
+static void count_tokens_task(void* arg, int thread_index, int thread_count) {
+    ParallelParseData* data = (ParallelParseData*)arg;
+    for (int t = thread_index; t < data->chunk_count; t += thread_count) {
+        ParseChunk* chunk = &data->chunks[t];
+        chunk->count = count_tokens(chunk->begin, chunk->end);
+    }
+}
+
+static void parse_chunk_task(void* arg, int thread_index, int thread_count) {
+    ParallelParseData* data = (ParallelParseData*)arg;
+
+    for (int t = thread_index; t < data->chunk_count; t += thread_count) {
+        ParseChunk* chunk = &data->chunks[t];
+        if (chunk->first_index >= data->total) continue;
+
+        size_t count = chunk->count;
+        if (chunk->first_index + count > data->total) {
+            count = data->total - chunk->first_index;
+        }
+
+        if (!parse_values(chunk->begin, chunk->end, data->matrix, chunk->first_index, count, &chunk->failed_index)) {
+            chunk->failed = 1;
+        }
+    }
+}
+
+// Куски режутся по границам строк, сдвиги элементов считаются префиксной суммой
+static int parse_values_parallel(const char* begin, const char* end, Matrix* matrix,
+                                 int max_threads, size_t* failed_index) {
+    ParseChunk* chunks = (ParseChunk*)calloc(max_threads, sizeof(ParseChunk));
+    if (!chunks) return 0;
+
+    size_t length = (size_t)(end - begin);
+    const char* cursor = begin;
+    for (int t = 0; t < max_threads; t++) {
+        const char* chunk_end = (t == max_threads - 1) ? end : begin + length / max_threads * (t + 1);
+        if (chunk_end < cursor) chunk_end = cursor;
+        while (chunk_end < end && *chunk_end != '\n') chunk_end++;
+        chunks[t].begin = cursor;
+        chunks[t].end = chunk_end;
+        cursor = chunk_end;
+    }
+
+    ParallelParseData data;
+    data.chunks = chunks;
+    data.chunk_count = max_threads;
+    data.matrix = matrix;
+    data.total = (size_t)matrix->size * matrix->size;
+
+    ThreadPool* pool = thread_pool_shared(max_threads);
+    thread_pool_run(pool, max_threads, count_tokens_task, &data);
+
+    size_t index = 0;
+    for (int t = 0; t < max_threads; t++) {
+        chunks[t].first_index = index;
+        index += chunks[t].count;
+    }
+
+    if (index < data.total) {
+        *failed_index = index;
+        free(chunks);
+        return 0;
+    }
+
+    thread_pool_run(pool, max_threads, parse_chunk_task, &data);
+
+    int ok = 1;
+    for (int t = 0; t < max_threads; t++) {
+        if (chunks[t].failed) {
+            *failed_index = chunks[t].failed_index;
+            ok = 0;
+            break;
+        }
+    }
+
+    free(chunks);
+    return ok;
+}
 
 Matrix* matrix_read_from_file(const char* filename) {
+    return matrix_read_from_file_threads(filename, 1);
+}
+
+// Диапазон проверяется до приведения к int: double больше INT_MAX в int не влезает
+static int valid_size_value(double size_value) {
+    return size_value >= 1 && size_value <= MATRIX_MAX_FILE_SIZE &&
+           size_value == (double)(int)size_value;
+}
+
+static Matrix* parse_text_matrix(const char* content, size_t length, int max_threads, const char* filename) {
+    const char* end = content + length;
+    const char* p = skip_spaces(content, end);
+    double size_value = 0.0;
+    const char* after_size = (p < end) ? parse_number(p, end, &size_value) : NULL;
+
+    if (!after_size) {
+        printf("Ошибка: не удалось прочитать размер матрицы из файла '%s'\n", filename);
+        return NULL;
+    }
+
+    if (!valid_size_value(size_value)) {
+        printf("Ошибка: некорректный размер матрицы %.15g (должен быть целым от 1 до %d)\n",
+               size_value, MATRIX_MAX_FILE_SIZE);
+        return NULL;
+    }
+    int size = (int)size_value;
+
+    Matrix* matrix = matrix_create(size);
+    if (!matrix) {
+        printf("Ошибка: не удалось создать матрицу размера %d\n", size);
+        return NULL;
+    }
+
+    size_t failed_index = 0;
+    int ok;
+    if (max_threads > 1 && (size_t)(end - after_size) >= PARALLEL_PARSE_MIN_BYTES) {
+        ok = parse_values_parallel(after_size, end, matrix, max_threads, &failed_index);
+    } else {
+        ok = parse_values(after_size, end, matrix, 0, (size_t)size * size, &failed_index) != NULL;
+    }
+
+    if (!ok) {
+        printf("Ошибка: не удалось прочитать элемент [%d][%d] из файла '%s'\n",
+               (int)(failed_index / size), (int)(failed_index % size), filename);
+        matrix_free(matrix);
+        return NULL;
+    }
+
+    return matrix;
+}
+
+static int check_binary_header(const MatrixFileHeader* header, size_t length, const char* filename) {
+    if (header->version != MATRIX_FILE_VERSION || header->dtype != MATRIX_DTYPE_FLOAT64 ||
+        header->byte_order != MATRIX_BYTE_ORDER_MARK) {
+        printf("Ошибка: неподдерживаемая версия или тип данных в файле '%s'\n", filename);
+        return 0;
+    }
+
+    if (header->size == 0 || header->size > (uint64_t)MATRIX_MAX_FILE_SIZE ||
+        header->stride < header->size || header->data_offset < sizeof(MatrixFileHeader) ||
+        header->data_offset > length ||
+        (length - header->data_offset) / sizeof(double) / header->stride < header->size) {
+        printf("Ошибка: поврежденный заголовок или усеченный файл '%s'\n", filename);
+        return 0;
+    }
+
+    return 1;
+}
+
+// Файл отображается с MAP_PRIVATE: рабочая копия ядра остается единственной копией данных
+static Matrix* load_binary_matrix(int fd, size_t length, const char* filename) {
+    void* mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        printf("Ошибка: не удалось отобразить файл '%s': %s\n", filename, strerror(errno));
+        return NULL;
+    }
+
+    const MatrixFileHeader* header = (const MatrixFileHeader*)mapping;
+    if (!check_binary_header(header, length, filename)) {
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    int size = (int)header->size;
+    int stride = (int)header->stride;
+    double* values = (double*)((char*)mapping + header->data_offset);
+
+    if (header->data_offset % MATRIX_ALIGNMENT == 0 && stride % (MATRIX_ALIGNMENT / (int)sizeof(double)) == 0) {
+        Matrix* matrix = matrix_wrap_mapping(mapping, length, values, size, stride);
+        if (!matrix) {
+            printf("Ошибка: не удалось создать матрицу размера %d\n", size);
+            munmap(mapping, length);
+        }
+        return matrix;
+    }
+
+    // Невыровненные строки копируются в обычное хранилище
+    Matrix* matrix = matrix_create(size);
+    if (matrix) {
+        for (int i = 0; i < size; i++) {
+            memcpy(matrix->data[i], values + (size_t)i * stride, (size_t)size * sizeof(double));
+        }
+    } else {
+        printf("Ошибка: не удалось создать матрицу размера %d\n", size);
+    }
+    munmap(mapping, length);
+    return matrix;
+}
+
+Matrix* matrix_read_from_file_threads(const char* filename, int max_threads) {
     if (!filename) {
         printf("Ошибка: не указано имя файла\n");
         return NULL;
     }
 
-    FILE* file = fopen(filename, "r");
-    if (!file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         printf("Ошибка: не удалось открыть файл '%s': %s\n", filename, strerror(errno));
         return NULL;
     }
 
-    int size;
-    if (fscanf(file, "%d", &size) != 1) {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
         printf("Ошибка: не удалось прочитать размер матрицы из файла '%s'\n", filename);
-        fclose(file);
+        close(fd);
         return NULL;
     }
 
-    if (size <= 0) {
-        printf("Ошибка: некорректный размер матрицы %d (должен быть от 1 до 50)\n", size);
-        fclose(file);
-        return NULL;
+    size_t length = (size_t)info.st_size;
+
+    char magic[sizeof(((MatrixFileHeader*)0)->magic)];
+    if (length >= sizeof(MatrixFileHeader) && pread(fd, magic, sizeof(magic), 0) == (ssize_t)sizeof(magic) &&
+        memcmp(magic, MATRIX_FILE_MAGIC, sizeof(magic)) == 0) {
+        Matrix* matrix = load_binary_matrix(fd, length, filename);
+        close(fd);
+        return matrix;
     }
 
-    Matrix* matrix = matrix_create(size);
-    if (!matrix) {
-        printf("Ошибка: не удалось создать матрицу размера %d\n", size);
-        fclose(file);
+    const char* content = (const char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (content == MAP_FAILED) {
+        printf("Ошибка: не удалось отобразить файл '%s': %s\n", filename, strerror(errno));
         return NULL;
     }
+    madvise((void*)content, length, MADV_SEQUENTIAL);
+
+    Matrix* matrix = parse_text_matrix(content, length, max_threads, filename);
+
+    munmap((void*)content, length);
+    return matrix;
+}
+
+static int append_matrix(Matrix*** matrices, int* count, int* capacity, Matrix* matrix) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 16;
+        Matrix** grown = (Matrix**)realloc(*matrices, new_capacity * sizeof(Matrix*));
+        if (!grown) return 0;
+        *matrices = grown;
+        *capacity = new_capacity;
+    }
+    (*matrices)[(*count)++] = matrix;
+    return 1;
+}
+
+// Несколько матриц подряд: текстовые "N, затем N*N чисел" или двоичные блоки заголовок+данные.
+// N больше max_size отклоняется до выделения памяти
+int matrix_parse_collection(const char* content, size_t length, Matrix*** matrices, int* count,
+                            const char* name, int max_size) {
+    *matrices = NULL;
+    *count = 0;
+    int capacity = 0;
+    int binary = length >= sizeof(MatrixFileHeader) && memcmp(content, MATRIX_FILE_MAGIC, 8) == 0;
+
+    const char* end = content + length;
+    const char* p = content;
+
+    for (;;) {
+        Matrix* matrix = NULL;
+
+        if (binary) {
+            size_t offset = (size_t)(p - content);
+            if (offset >= length) break;
+
+            MatrixFileHeader header;
+            if (length - offset < sizeof(header)) {
+                printf("Ошибка: усеченный блок матрицы %d в '%s'\n", *count, name);
+                goto fail;
+            }
+            memcpy(&header, p, sizeof(header));
+            if (memcmp(header.magic, MATRIX_FILE_MAGIC, 8) != 0 || !check_binary_header(&header, length - offset, name)) {
+                goto fail;
+            }
 
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < size; j++) {
-            if (fscanf(file, "%lf", &matrix->data[i][j]) != 1) {
-                printf("Ошибка: не удалось прочитать элемент [%d][%d] из файла '%s'\n", i, j, filename);
+            if (header.size > (uint64_t)max_size) {
+                printf("Ошибка: матрица %d в '%s' размера %d, предел %d\n", *count, name, (int)header.size, max_size);
+                goto fail;
+            }
+
+            int size = (int)header.size;
+            const char* values = p + header.data_offset;
+            matrix = matrix_create(size);
+            if (!matrix) goto fail;
+            for (int i = 0; i < size; i++) {
+                memcpy(matrix->data[i], values + (size_t)i * header.stride * sizeof(double), (size_t)size * sizeof(double));
+            }
+            p = values + (size_t)size * header.stride * sizeof(double);
+        } else {
+            p = skip_spaces(p, end);
+            if (p >= end) break;
+
+            double size_value = 0.0;
+            const char* after_size = parse_number(p, end, &size_value);
+            if (!after_size || !valid_size_value(size_value)) {
+                printf("Ошибка: не удалось прочитать размер матрицы %d из '%s'\n", *count, name);
+                goto fail;
+            }
+
+            if (size_value > max_size) {
+                printf("Ошибка: матрица %d в '%s' размера %d, предел %d\n", *count, name, (int)size_value, max_size);
+                goto fail;
+            }
+
+            // На каждое из N*N чисел нужен хотя бы символ и разделитель - короткий хвост не выделяем
+            int size = (int)size_value;
+            if ((size_t)size * size > (size_t)(end - after_size) / 2) {
+                printf("Ошибка: усеченная матрица %d в '%s'\n", *count, name);
+                goto fail;
+            }
+
+            matrix = matrix_create(size);
+            if (!matrix) goto fail;
+
+            size_t failed_index = 0;
+            p = parse_values(after_size, end, matrix, 0, (size_t)size * size, &failed_index);
+            if (!p) {
+                printf("Ошибка: не удалось прочитать элемент [%d][%d] матрицы %d из '%s'\n",
+                       (int)(failed_index / size), (int)(failed_index % size), *count, name);
                 matrix_free(matrix);
-                fclose(file);
-                return NULL;
+                goto fail;
             }
         }
+
+        if (!append_matrix(matrices, count, &capacity, matrix)) {
+            matrix_free(matrix);
+            goto fail;
+        }
     }
 
+    return 1;
+
+fail:
+    for (int i = 0; i < *count; i++) {
+        matrix_free((*matrices)[i]);
+    }
+    free(*matrices);
+    *matrices = NULL;
+    *count = 0;
+    return 0;
+}
+
+int matrix_read_collection(const char* filename, Matrix*** matrices, int* count) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        printf("Ошибка: не удалось открыть файл '%s': %s\n", filename, strerror(errno));
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        printf("Ошибка: пустой файл '%s'\n", filename);
+        close(fd);
+        return 0;
+    }
+
+    size_t length = (size_t)info.st_size;
+    const char* content = (const char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (content == MAP_FAILED) {
+        printf("Ошибка: не удалось отобразить файл '%s': %s\n", filename, strerror(errno));
+        return 0;
+    }
+
+    int ok = matrix_parse_collection(content, length, matrices, count, filename, MATRIX_MAX_FILE_SIZE);
+    munmap((void*)content, length);
+    return ok;
+}
+
+// Размер матрицы по заголовку файла без чтения данных, -1 если это не матрица
+int matrix_peek_file_size(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return -1;
+
+    char head[sizeof(MatrixFileHeader)];
+    size_t length = fread(head, 1, sizeof(head), file);
     fclose(file);
-    return matrix;
+
+    if (length == sizeof(MatrixFileHeader) && memcmp(head, MATRIX_FILE_MAGIC, 8) == 0) {
+        MatrixFileHeader header;
+        memcpy(&header, head, sizeof(header));
+        return (header.size > 0 && header.size <= MATRIX_MAX_FILE_SIZE) ? (int)header.size : -1;
+    }
+
+    const char* p = skip_spaces(head, head + length);
+    const char* token_end = p;
+    while (token_end < head + length && !is_space(*token_end)) token_end++;
+    if (token_end == head + length && length == sizeof(head)) return -1;
+
+    double size_value = 0.0;
+    if (p == token_end || !parse_number(p, token_end, &size_value) ||
+        !valid_size_value(size_value)) {
+        return -1;
+    }
+    return (int)size_value;
+}
+
+static int reserve_save_buffer(SaveChunk* chunk, size_t extra) {
+    if (chunk->length + extra <= chunk->capacity) return 1;
+
+    size_t capacity = chunk->capacity ? chunk->capacity : SAVE_ROUND_BYTES;
+    while (capacity < chunk->length + extra) capacity *= 2;
+    char* grown = (char*)realloc(chunk->text, capacity);
+    if (!grown) return 0;
+    chunk->text = grown;
+    chunk->capacity = capacity;
+    return 1;
+}
+
+// Строки своей полосы текущего раунда - в свой буфер, тем же "%.6f", что и прежний fprintf
+static void format_rows_chunk(ParallelSaveData* data, int index) {
+    SaveChunk* chunk = &data->chunks[index];
+    int rows = data->end_row - data->start_row;
+    int start_row = data->start_row + (int)((int64_t)rows * index / data->chunk_count);
+    int end_row = data->start_row + (int)((int64_t)rows * (index + 1) / data->chunk_count);
+    int n = data->matrix->size;
+
+    chunk->length = 0;
+    for (int i = start_row; i < end_row && !chunk->failed; i++) {
+        const double* row = data->matrix->data[i];
+        for (int j = 0; j < n; j++) {
+            if (!reserve_save_buffer(chunk, MAX_TOKEN_LENGTH)) {
+                chunk->failed = ENOMEM;
+                break;
+            }
+            size_t room = chunk->capacity - chunk->length;
+            int written = snprintf(chunk->text + chunk->length, room, "%.6f", row[j]);
+            if (written >= 0 && (size_t)written >= room - 1) {
+                // Очень большие значения длиннее запаса: буфер растет и строка печатается заново
+                if (!reserve_save_buffer(chunk, (size_t)written + 2)) {
+                    chunk->failed = ENOMEM;
+                    break;
+                }
+                written = snprintf(chunk->text + chunk->length, (size_t)written + 1, "%.6f", row[j]);
+            }
+            chunk->length += (size_t)written;
+            chunk->text[chunk->length++] = (j < n - 1) ? ' ' : '\n';
+        }
+    }
+}
+
+static void write_chunk(ParallelSaveData* data, int index) {
+    SaveChunk* chunk = &data->chunks[index];
+
+    size_t done = 0;
+    while (!chunk->failed && done < chunk->length) {
+        ssize_t written = pwrite(data->fd, chunk->text + done, chunk->length - done, chunk->offset + (off_t)done);
+        if (written < 0) {
+            if (errno != EINTR) chunk->failed = errno;
+        } else {
+            done += (size_t)written;
+        }
+    }
+}
+
+// Полос chunk_count, потоков в запуске может оказаться меньше
+static void format_rows_task(void* arg, int thread_index, int thread_count) {
+    ParallelSaveData* data = (ParallelSaveData*)arg;
+    for (int c = thread_index; c < data->chunk_count; c += thread_count) {
+        format_rows_chunk(data, c);
+    }
+}
+
+static void write_rows_task(void* arg, int thread_index, int thread_count) {
+    ParallelSaveData* data = (ParallelSaveData*)arg;
+    for (int c = thread_index; c < data->chunk_count; c += thread_count) {
+        write_chunk(data, c);
+    }
+}
+
+// Раундами по SAVE_ROUND_BYTES на поток: потоки печатают свои полосы строк в буферы,
+// сдвиги в файле - префиксная сумма длин, затем каждый пишет свой буфер через pwrite
+int matrix_save_to_file_threads(const Matrix* matrix, const char* filename, int max_threads) {
+    if (!matrix_is_valid(matrix) || !filename) {
+        return 0;
+    }
+    if (max_threads < 1) max_threads = 1;
+
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Ошибка: не удалось создать файл '%s': %s\n", filename, strerror(errno));
+        return 0;
+    }
+
+    int n = matrix->size;
+    int threads = max_threads < n ? max_threads : n;
+    SaveChunk* chunks = (SaveChunk*)calloc(threads, sizeof(SaveChunk));
+    if (!chunks) {
+        close(fd);
+        printf("Ошибка: недостаточно памяти для записи файла '%s'\n", filename);
+        return 0;
+    }
+
+    ParallelSaveData data;
+    data.matrix = matrix;
+    data.chunks = chunks;
+    data.chunk_count = threads;
+    data.fd = fd;
+
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "%d\n", n);
+    int error = pwrite(fd, header, header_length, 0) == header_length ? 0 : (errno ? errno : EIO);
+    off_t offset = header_length;
+
+    // Около 12 байт на элемент для небольших целых: оценка только для размера раунда
+    size_t row_bytes = (size_t)n * 12 + 1;
+    int rows_per_round = (int)((size_t)SAVE_ROUND_BYTES * threads / row_bytes);
+    if (rows_per_round < threads) rows_per_round = threads;
+
+    ThreadPool* pool = threads > 1 ? thread_pool_shared(threads) : NULL;
+    for (int row = 0; row < n && !error; row += rows_per_round) {
+        data.start_row = row;
+        data.end_row = row + rows_per_round < n ? row + rows_per_round : n;
+        thread_pool_run(pool, threads, format_rows_task, &data);
+
+        for (int t = 0; t < threads; t++) {
+            chunks[t].offset = offset;
+            offset += (off_t)chunks[t].length;
+        }
+        thread_pool_run(pool, threads, write_rows_task, &data);
+
+        for (int t = 0; t < threads && !error; t++) {
+            error = chunks[t].failed;
+        }
+    }
+
+    for (int t = 0; t < threads; t++) {
+        free(chunks[t].text);
+    }
+    free(chunks);
+
+    if (close(fd) != 0 && !error) {
+        error = errno;
+    }
+    if (error) {
+        printf("Ошибка: не удалось записать файл '%s': %s\n", filename, strerror(error));
+        return 0;
+    }
+    return 1;
 }
 
 int matrix_save_to_file(const Matrix* matrix, const char* filename) {
+    return matrix_save_to_file_threads(matrix, filename, 1);
+}
+
+int matrix_save_to_file_binary(const Matrix* matrix, const char* filename) {
     if (!matrix_is_valid(matrix) || !filename) {
         return 0;
     }
-    
-    FILE* file = fopen(filename, "w");
+
+    FILE* file = fopen(filename, "wb");
     if (!file) {
         printf("Ошибка: не удалось создать файл '%s': %s\n", filename, strerror(errno));
         return 0;
     }
-    
-    fprintf(file, "%d\n", matrix->size);
-    
-    for (int i = 0; i < matrix->size; i++) {
-        for (int j = 0; j < matrix->size; j++) {
-            fprintf(file, "%.6f", matrix->data[i][j]);
-            if (j < matrix->size - 1) {
-                fprintf(file, " ");
-            }
+
+    int n = matrix->size;
+    int stride = matrix_stride(n);
+
+    MatrixFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+    header.version = MATRIX_FILE_VERSION;
+    header.dtype = MATRIX_DTYPE_FLOAT64;
+    header.byte_order = MATRIX_BYTE_ORDER_MARK;
+    header.size = (uint64_t)n;
+    header.stride = (uint64_t)stride;
+    header.data_offset = sizeof(MatrixFileHeader);
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    if (ok && matrix->stride == stride) {
+        ok = fwrite(matrix->values, sizeof(double) * stride, n, file) == (size_t)n;
+    } else if (ok) {
+        double* row = (double*)calloc(stride, sizeof(double));
+        ok = row != NULL;
+        for (int i = 0; ok && i < n; i++) {
+            memcpy(row, matrix->data[i], (size_t)n * sizeof(double));
+            ok = fwrite(row, sizeof(double), stride, file) == (size_t)stride;
         }
-        fprintf(file, "\n");
+        free(row);
     }
-    
-    fclose(file);
-    return 1;
+
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        printf("Ошибка: не удалось записать файл '%s': %s\n", filename, strerror(errno));
+    }
+    return ok;
+}
+
+int matrix_save_to_file_format(const Matrix* matrix, const char* filename, MatrixFileFormat format, int max_threads) {
+    if (format == MATRIX_FORMAT_BINARY) {
+        return matrix_save_to_file_binary(matrix, filename);
+    }
+    return matrix_save_to_file_threads(matrix, filename, max_threads);
 }
 
 int file_exists(const char* filename) {
@@ -91,19 +773,18 @@ int file_exists(const char* filename) {
     return 0;
 }
 
-int create_sample_matrix_file(const char* filename, int size, int min_val, int max_val) {
+int create_sample_matrix_file(const char* filename, int size, int min_val, int max_val, MatrixFileFormat format,
+                              int max_threads) {
     if (!filename || size <= 0 || min_val >= max_val) {
         return 0;
     }
     
-    Matrix* matrix = matrix_create(size);
+    Matrix* matrix = matrix_create_random(size, min_val, max_val, max_threads);
     if (!matrix) {
         return 0;
     }
     
-    matrix_fill_random(matrix, min_val, max_val);
-    
-    int result = matrix_save_to_file(matrix, filename);
+    int result = matrix_save_to_file_format(matrix, filename, format, max_threads);
     matrix_free(matrix);
     
     return result;
@@ -112,7 +793,7 @@ int create_sample_matrix_file(const char* filename, int size, int min_val, int m
 void print_matrix_file_format_help(void) {
     printf("=== Формат файла матрицы ===\n\n");
     printf("Файл должен содержать:\n");
-    printf("1. Первая строка: размер матрицы (целое число от 1 до 20)\n");
+    printf("1. Первая строка: размер матрицы (целое число от 1 до %d)\n", MATRIX_MAX_FILE_SIZE);
     printf("2. Следующие строки: элементы матрицы (вещественные числа)\n\n");
     printf("Пример файла для матрицы 3x3:\n");
     printf("3\n");
@@ -122,5 +803,8 @@ void print_matrix_file_format_help(void) {
     printf("Примечания:\n");
     printf("- Элементы в строке разделяются пробелами\n");
     printf("- Можно использовать целые числа (они будут преобразованы в вещественные)\n");
-    printf("- Пустые строки и лишние пробелы игнорируются\n");
+    printf("- Пустые строки и лишние пробелы игнорируются\n\n");
+    printf("Двоичный формат (--binary при --save и --create-sample) распознается по сигнатуре:\n");
+    printf("- заголовок 64 байта: \"%s\", версия, тип (1 = double), N, ведущая размерность, смещение данных\n", MATRIX_FILE_MAGIC);
+    printf("- затем N строк double (порядок байт машины), выровненных по 64 байта\n");
 }
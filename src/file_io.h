@@ -2,11 +2,45 @@
 #define FILE_IO_H
 
 #include "matrix.h"
+#include <stdint.h>
+
+// Двоичный формат: заголовок 64 байта, затем строки double с ведущей размерностью stride
+#define MATRIX_FILE_MAGIC "DETMATRX"
+#define MATRIX_FILE_VERSION 1
+#define MATRIX_DTYPE_FLOAT64 1
+#define MATRIX_BYTE_ORDER_MARK 0x01020304u
+#define MATRIX_MAX_FILE_SIZE 1000000
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t byte_order;
+    uint32_t reserved0;
+    uint64_t size;
+    uint64_t stride;
+    uint64_t data_offset;
+    char reserved[16];
+} MatrixFileHeader;
+
+typedef enum {
+    MATRIX_FORMAT_TEXT,
+    MATRIX_FORMAT_BINARY
+} MatrixFileFormat;
 
 Matrix* matrix_read_from_file(const char* filename);
+Matrix* matrix_read_from_file_threads(const char* filename, int max_threads);
+int matrix_read_collection(const char* filename, Matrix*** matrices, int* count);
+int matrix_parse_collection(const char* content, size_t length, Matrix*** matrices, int* count,
+                            const char* name, int max_size);
+int matrix_peek_file_size(const char* filename);
 int matrix_save_to_file(const Matrix* matrix, const char* filename);
+int matrix_save_to_file_threads(const Matrix* matrix, const char* filename, int max_threads);
+int matrix_save_to_file_binary(const Matrix* matrix, const char* filename);
+int matrix_save_to_file_format(const Matrix* matrix, const char* filename, MatrixFileFormat format, int max_threads);
 int file_exists(const char* filename);
-int create_sample_matrix_file(const char* filename, int size, int min_val, int max_val);
+int create_sample_matrix_file(const char* filename, int size, int min_val, int max_val, MatrixFileFormat format,
+                              int max_threads);
 void print_matrix_file_format_help(void);
 
 #endif 
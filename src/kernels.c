@@ -0,0 +1,234 @@
+#include "kernels.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+static void row_update_scalar(double* restrict target, const double* restrict source, double factor, int count) {
+    for (int i = 0; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+static void row_update_float_scalar(float* restrict target, const float* restrict source, float factor, int count) {
+    for (int i = 0; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+static int supported_always(void) {
+    return 1;
+}
+
+#ifdef KERNELS_X86
+
+__attribute__((target("sse2")))
+static void row_update_sse2(double* restrict target, const double* restrict source, double factor, int count) {
+    __m128d f = _mm_set1_pd(factor);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128d t0 = _mm_loadu_pd(target + i);
+        __m128d t1 = _mm_loadu_pd(target + i + 2);
+        t0 = _mm_sub_pd(t0, _mm_mul_pd(f, _mm_loadu_pd(source + i)));
+        t1 = _mm_sub_pd(t1, _mm_mul_pd(f, _mm_loadu_pd(source + i + 2)));
+        _mm_storeu_pd(target + i, t0);
+        _mm_storeu_pd(target + i + 2, t1);
+    }
+    for (; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void row_update_avx2(double* restrict target, const double* restrict source, double factor, int count) {
+    __m256d f = _mm256_set1_pd(factor);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256d t0 = _mm256_loadu_pd(target + i);
+        __m256d t1 = _mm256_loadu_pd(target + i + 4);
+        t0 = _mm256_fnmadd_pd(f, _mm256_loadu_pd(source + i), t0);
+        t1 = _mm256_fnmadd_pd(f, _mm256_loadu_pd(source + i + 4), t1);
+        _mm256_storeu_pd(target + i, t0);
+        _mm256_storeu_pd(target + i + 4, t1);
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m256d t = _mm256_loadu_pd(target + i);
+        _mm256_storeu_pd(target + i, _mm256_fnmadd_pd(f, _mm256_loadu_pd(source + i), t));
+    }
+    for (; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void row_update_avx512(double* restrict target, const double* restrict source, double factor, int count) {
+    __m512d f = _mm512_set1_pd(factor);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512d t0 = _mm512_loadu_pd(target + i);
+        __m512d t1 = _mm512_loadu_pd(target + i + 8);
+        t0 = _mm512_fnmadd_pd(f, _mm512_loadu_pd(source + i), t0);
+        t1 = _mm512_fnmadd_pd(f, _mm512_loadu_pd(source + i + 8), t1);
+        _mm512_storeu_pd(target + i, t0);
+        _mm512_storeu_pd(target + i + 8, t1);
+    }
+    // Хвост через маску, без скалярного цикла
+    for (; i < count; i += 8) {
+        int left = count - i;
+        __mmask8 mask = (__mmask8)(left >= 8 ? 0xFF : (1u << left) - 1);
+        __m512d t = _mm512_maskz_loadu_pd(mask, target + i);
+        __m512d s = _mm512_maskz_loadu_pd(mask, source + i);
+        _mm512_mask_storeu_pd(target + i, mask, _mm512_fnmadd_pd(f, s, t));
+    }
+}
+
+__attribute__((target("sse2")))
+static void row_update_float_sse2(float* restrict target, const float* restrict source, float factor, int count) {
+    __m128 f = _mm_set1_ps(factor);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 t0 = _mm_loadu_ps(target + i);
+        __m128 t1 = _mm_loadu_ps(target + i + 4);
+        t0 = _mm_sub_ps(t0, _mm_mul_ps(f, _mm_loadu_ps(source + i)));
+        t1 = _mm_sub_ps(t1, _mm_mul_ps(f, _mm_loadu_ps(source + i + 4)));
+        _mm_storeu_ps(target + i, t0);
+        _mm_storeu_ps(target + i + 4, t1);
+    }
+    for (; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void row_update_float_avx2(float* restrict target, const float* restrict source, float factor, int count) {
+    __m256 f = _mm256_set1_ps(factor);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 t0 = _mm256_loadu_ps(target + i);
+        __m256 t1 = _mm256_loadu_ps(target + i + 8);
+        t0 = _mm256_fnmadd_ps(f, _mm256_loadu_ps(source + i), t0);
+        t1 = _mm256_fnmadd_ps(f, _mm256_loadu_ps(source + i + 8), t1);
+        _mm256_storeu_ps(target + i, t0);
+        _mm256_storeu_ps(target + i + 8, t1);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256 t = _mm256_loadu_ps(target + i);
+        _mm256_storeu_ps(target + i, _mm256_fnmadd_ps(f, _mm256_loadu_ps(source + i), t));
+    }
+    for (; i < count; i++) {
+        target[i] -= factor * source[i];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void row_update_float_avx512(float* restrict target, const float* restrict source, float factor, int count) {
+    __m512 f = _mm512_set1_ps(factor);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m512 t0 = _mm512_loadu_ps(target + i);
+        __m512 t1 = _mm512_loadu_ps(target + i + 16);
+        t0 = _mm512_fnmadd_ps(f, _mm512_loadu_ps(source + i), t0);
+        t1 = _mm512_fnmadd_ps(f, _mm512_loadu_ps(source + i + 16), t1);
+        _mm512_storeu_ps(target + i, t0);
+        _mm512_storeu_ps(target + i + 16, t1);
+    }
+    for (; i < count; i += 16) {
+        int left = count - i;
+        __mmask16 mask = (__mmask16)(left >= 16 ? 0xFFFF : (1u << left) - 1);
+        __m512 t = _mm512_maskz_loadu_ps(mask, target + i);
+        __m512 src = _mm512_maskz_loadu_ps(mask, source + i);
+        _mm512_mask_storeu_ps(target + i, mask, _mm512_fnmadd_ps(f, src, t));
+    }
+}
+
+static int supported_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static int supported_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static int supported_avx512(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+
+#endif
+
+// Порядок от лучшего к худшему: auto берет первое поддерживаемое
+static const EliminationKernel kernels[] = {
+#ifdef KERNELS_X86
+    {"avx512", row_update_avx512, row_update_float_avx512, supported_avx512},
+    {"avx2", row_update_avx2, row_update_float_avx2, supported_avx2},
+    {"sse2", row_update_sse2, row_update_float_sse2, supported_sse2},
+#endif
+    {"scalar", row_update_scalar, row_update_float_scalar, supported_always},
+};
+
+static const EliminationKernel* selected_kernel = NULL;
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+
+static void kernel_select_default(void) {
+    if (!selected_kernel) {
+        kernel_select("auto");
+    }
+}
+
+void kernel_init(void) {
+    pthread_once(&kernel_once, kernel_select_default);
+}
+
+static void row_update_resolve(double* restrict target, const double* restrict source, double factor, int count) {
+    kernel_init();
+    row_update(target, source, factor, count);
+}
+
+static void row_update_float_resolve(float* restrict target, const float* restrict source, float factor, int count) {
+    kernel_init();
+    row_update_float(target, source, factor, count);
+}
+
+RowUpdateKernel row_update = row_update_resolve;
+RowUpdateKernelFloat row_update_float = row_update_float_resolve;
+
+int kernel_select(const char* name) {
+    int count = (int)(sizeof(kernels) / sizeof(kernels[0]));
+    int automatic = (name == NULL || strcmp(name, "auto") == 0);
+
+    for (int i = 0; i < count; i++) {
+        if (!automatic && strcmp(kernels[i].name, name) != 0) {
+            continue;
+        }
+        if (!kernels[i].supported()) {
+            if (automatic) continue;
+            return 0;
+        }
+        selected_kernel = &kernels[i];
+        row_update = kernels[i].update;
+        row_update_float = kernels[i].update_float;
+        return 1;
+    }
+
+    return 0;
+}
+
+const char* kernel_name(void) {
+    kernel_init();
+    return selected_kernel->name;
+}
+
+void kernel_print_available(void) {
+    int count = (int)(sizeof(kernels) / sizeof(kernels[0]));
+    printf("auto");
+    for (int i = 0; i < count; i++) {
+        printf(", %s%s", kernels[i].name, kernels[i].supported() ? "" : " (не поддерживается)");
+    }
+    printf("\n");
+}
@@ -0,0 +1,29 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// target[0..count) -= factor * source[0..count)
+typedef void (*RowUpdateKernel)(double* restrict target, const double* restrict source, double factor, int count);
+
+// То же в одинарной точности: вдвое больше элементов на SIMD-регистр
+typedef void (*RowUpdateKernelFloat)(float* restrict target, const float* restrict source, float factor, int count);
+
+typedef struct {
+    const char* name;
+    RowUpdateKernel update;
+    RowUpdateKernelFloat update_float;
+    int (*supported)(void);
+} EliminationKernel;
+
+// Текущее ядро: выбирается по CPUID при первом вызове или ключом --kernel
+extern RowUpdateKernel row_update;
+extern RowUpdateKernelFloat row_update_float;
+
+// kernel_select меняет указатели без синхронизации: только до запуска потоков (разбор --kernel)
+int kernel_select(const char* name);
+
+// Ядро по CPUID, если не выбрано --kernel; main вызывает до создания пула, повторные вызовы ничего не делают
+void kernel_init(void);
+const char* kernel_name(void);
+void kernel_print_available(void);
+
+#endif
@@ -0,0 +1,303 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "lu_update.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// После стольких обновлений дешевле и точнее факторизовать заново
+#define LU_UPDATE_MAX 32
+// |1 + v^T A^-1 u| меньше порога: детерминант почти обнулился, цифры теряются в сокращении
+#define LU_UPDATE_MIN_ALPHA 1e-8
+#define LU_UPDATE_MAX_ALPHA 1e8
+
+static double** allocate_vectors(int count, int size) {
+    double** vectors = (double**)calloc(count, sizeof(double*));
+    if (!vectors) return NULL;
+    for (int i = 0; i < count; i++) {
+        vectors[i] = (double*)malloc(size * sizeof(double));
+        if (!vectors[i]) {
+            for (int j = 0; j < i; j++) free(vectors[j]);
+            free(vectors);
+            return NULL;
+        }
+    }
+    return vectors;
+}
+
+static void free_vectors(double** vectors, int count) {
+    if (!vectors) return;
+    for (int i = 0; i < count; i++) free(vectors[i]);
+    free(vectors);
+}
+
+void lu_updater_free(LUUpdater* updater) {
+    if (!updater) return;
+
+    matrix_free(updater->matrix);
+    if (updater->lu) free_matrix_data(updater->lu, updater->size);
+    free(updater->permutation);
+    free_vectors(updater->update_y, updater->max_updates);
+    free_vectors(updater->update_v, updater->max_updates);
+    free(updater->update_alpha);
+    free(updater->work_u);
+    free(updater->work_v);
+    free(updater);
+}
+
+LUUpdater* lu_updater_create(const Matrix* matrix, int max_threads) {
+    if (!matrix_is_valid(matrix)) {
+        return NULL;
+    }
+
+    LUUpdater* updater = (LUUpdater*)calloc(1, sizeof(LUUpdater));
+    if (!updater) return NULL;
+
+    int n = matrix->size;
+    updater->size = n;
+    updater->max_threads = max_threads;
+    updater->max_updates = LU_UPDATE_MAX;
+    updater->matrix = matrix_copy(matrix);
+    updater->permutation = (int*)malloc(n * sizeof(int));
+    updater->update_y = allocate_vectors(LU_UPDATE_MAX, n);
+    updater->update_v = allocate_vectors(LU_UPDATE_MAX, n);
+    updater->update_alpha = (double*)malloc(LU_UPDATE_MAX * sizeof(double));
+    updater->work_u = (double*)malloc(n * sizeof(double));
+    updater->work_v = (double*)malloc(n * sizeof(double));
+
+    if (!updater->matrix || !updater->permutation || !updater->update_y || !updater->update_v ||
+        !updater->update_alpha || !updater->work_u || !updater->work_v) {
+        lu_updater_free(updater);
+        return NULL;
+    }
+
+    if (!lu_updater_refactor(updater) && !updater->lu) {
+        lu_updater_free(updater);
+        return NULL;
+    }
+
+    return updater;
+}
+
+int lu_updater_refactor(LUUpdater* updater) {
+    int n = updater->size;
+
+    if (updater->lu) {
+        free_matrix_data(updater->lu, n);
+    }
+    updater->lu = copy_matrix_data(updater->matrix);
+    updater->update_count = 0;
+    updater->factored = 0;
+    updater->determinant = scaled_determinant_zero();
+    updater->refactor_count++;
+    if (!updater->lu) return 0;
+
+    int swap_count = 0;
+    if (!lu_factor_block(updater->lu, n, updater->max_threads, &swap_count)) {
+        // Вырожденная матрица: обновления будут пересчитываться целиком
+        return 0;
+    }
+
+    double* values = matrix_data_values(updater->lu, n);
+    int stride = updater->matrix->stride;
+    ScaledDeterminant det = scaled_determinant_one();
+    for (int i = 0; i < n; i++) {
+        updater->permutation[i] = (int)((updater->lu[i] - values) / stride);
+        scaled_determinant_multiply(&det, updater->lu[i][i]);
+    }
+    if (swap_count % 2 == 1) {
+        scaled_determinant_negate(&det);
+    }
+
+    updater->determinant = det;
+    updater->factored = 1;
+    return 1;
+}
+
+// x = A^-1 b для текущей матрицы: LU исходной, затем накопленные поправки
+static void solve_current(const LUUpdater* updater, const double* b, double* x) {
+    int n = updater->size;
+    double** lu = updater->lu;
+
+    for (int i = 0; i < n; i++) {
+        double sum = b[updater->permutation[i]];
+        const double* row = lu[i];
+        for (int j = 0; j < i; j++) sum -= row[j] * x[j];
+        x[i] = sum;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        double sum = x[i];
+        const double* row = lu[i];
+        for (int j = i + 1; j < n; j++) sum -= row[j] * x[j];
+        x[i] = sum / row[i];
+    }
+
+    for (int k = 0; k < updater->update_count; k++) {
+        const double* y = updater->update_y[k];
+        const double* v = updater->update_v[k];
+        double dot = 0.0;
+        for (int j = 0; j < n; j++) dot += v[j] * x[j];
+        double scale = dot / updater->update_alpha[k];
+        for (int j = 0; j < n; j++) x[j] -= scale * y[j];
+    }
+}
+
+// Матрица уже изменена на u v^T; здесь обновляются только детерминант и факторы
+static int apply_rank_one(LUUpdater* updater, const double* u, const double* v) {
+    int n = updater->size;
+
+    if (!updater->factored || updater->update_count >= updater->max_updates) {
+        lu_updater_refactor(updater);
+        return 1;
+    }
+
+    int k = updater->update_count;
+    double* y = updater->update_y[k];
+    solve_current(updater, u, y);
+
+    double alpha = 1.0;
+    for (int j = 0; j < n; j++) alpha += v[j] * y[j];
+
+    double magnitude = fabs(alpha);
+    if (!(magnitude >= LU_UPDATE_MIN_ALPHA && magnitude <= LU_UPDATE_MAX_ALPHA)) {
+        lu_updater_refactor(updater);
+        return 1;
+    }
+
+    memcpy(updater->update_v[k], v, n * sizeof(double));
+    updater->update_alpha[k] = alpha;
+    updater->update_count++;
+    scaled_determinant_multiply(&updater->determinant, alpha);
+    return 1;
+}
+
+int lu_updater_set(LUUpdater* updater, int row, int col, double value) {
+    int n = updater->size;
+    if (row < 0 || row >= n || col < 0 || col >= n) return 0;
+
+    double delta = value - updater->matrix->data[row][col];
+    if (delta == 0.0) return 1;
+    updater->matrix->data[row][col] = value;
+
+    memset(updater->work_u, 0, n * sizeof(double));
+    memset(updater->work_v, 0, n * sizeof(double));
+    updater->work_u[row] = delta;
+    updater->work_v[col] = 1.0;
+    return apply_rank_one(updater, updater->work_u, updater->work_v);
+}
+
+int lu_updater_set_row(LUUpdater* updater, int row, const double* values) {
+    int n = updater->size;
+    if (row < 0 || row >= n) return 0;
+
+    double* current = updater->matrix->data[row];
+    memset(updater->work_u, 0, n * sizeof(double));
+    updater->work_u[row] = 1.0;
+    for (int j = 0; j < n; j++) {
+        updater->work_v[j] = values[j] - current[j];
+        current[j] = values[j];
+    }
+    return apply_rank_one(updater, updater->work_u, updater->work_v);
+}
+
+int lu_updater_set_column(LUUpdater* updater, int col, const double* values) {
+    int n = updater->size;
+    if (col < 0 || col >= n) return 0;
+
+    memset(updater->work_v, 0, n * sizeof(double));
+    updater->work_v[col] = 1.0;
+    for (int i = 0; i < n; i++) {
+        updater->work_u[i] = values[i] - updater->matrix->data[i][col];
+        updater->matrix->data[i][col] = values[i];
+    }
+    return apply_rank_one(updater, updater->work_u, updater->work_v);
+}
+
+ScaledDeterminant lu_updater_determinant(const LUUpdater* updater) {
+    return updater->determinant;
+}
+
+static int read_values(FILE* in, double* values, int count) {
+    for (int i = 0; i < count; i++) {
+        if (fscanf(in, "%lf", &values[i]) != 1) return 0;
+    }
+    return 1;
+}
+
+static void print_updater_state(const LUUpdater* updater, double elapsed, FILE* out) {
+    ScaledDeterminant det = lu_updater_determinant(updater);
+    fprintf(out, "Детерминант: %.6f, знак: %d, ln|det|: %.9f, обновлений: %d, время: %.3f мс\n",
+            scaled_determinant_value(&det), scaled_determinant_sign(&det),
+            scaled_determinant_log(&det), updater->update_count, elapsed * 1000);
+    fflush(out);
+}
+
+// Аргументы неизвестной команды не должны читаться как следующие команды
+static void skip_line(FILE* in) {
+    int c;
+    while ((c = fgetc(in)) != EOF && c != '\n') {
+    }
+}
+
+int lu_update_stream(const Matrix* matrix, int max_threads, FILE* in, FILE* out) {
+    LUUpdater* updater = lu_updater_create(matrix, max_threads);
+    if (!updater) {
+        fprintf(out, "Ошибка: не удалось факторизовать матрицу\n");
+        return 0;
+    }
+
+    int n = updater->size;
+    double* values = (double*)malloc(n * sizeof(double));
+    if (!values) {
+        lu_updater_free(updater);
+        return 0;
+    }
+
+    print_updater_state(updater, 0.0, out);
+
+    char command[32];
+    while (fscanf(in, "%31s", command) == 1) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int ok = 1;
+
+        if (strcmp(command, "quit") == 0) {
+            break;
+        } else if (strcmp(command, "det") == 0) {
+            // Ничего не меняется, просто выводим текущее значение
+        } else if (strcmp(command, "refactor") == 0) {
+            lu_updater_refactor(updater);
+        } else if (strcmp(command, "set") == 0) {
+            int row, col;
+            double value;
+            ok = fscanf(in, "%d %d %lf", &row, &col, &value) == 3 && lu_updater_set(updater, row, col, value);
+        } else if (strcmp(command, "row") == 0) {
+            int row;
+            ok = fscanf(in, "%d", &row) == 1 && read_values(in, values, n) &&
+                 lu_updater_set_row(updater, row, values);
+        } else if (strcmp(command, "col") == 0) {
+            int col;
+            ok = fscanf(in, "%d", &col) == 1 && read_values(in, values, n) &&
+                 lu_updater_set_column(updater, col, values);
+        } else {
+            fprintf(out, "Ошибка: неизвестная команда %s (set, row, col, det, refactor, quit)\n", command);
+            skip_line(in);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!ok) {
+            fprintf(out, "Ошибка: некорректные аргументы команды %s\n", command);
+            skip_line(in);
+            continue;
+        }
+        print_updater_state(updater, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, out);
+    }
+
+    fprintf(out, "Полных факторизаций: %d\n", updater->refactor_count);
+
+    free(values);
+    lu_updater_free(updater);
+    return 1;
+}
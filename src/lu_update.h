@@ -0,0 +1,49 @@
+#ifndef LU_UPDATE_H
+#define LU_UPDATE_H
+
+#include "matrix.h"
+#include "determinant.h"
+#include <stdio.h>
+
+// Хранит LU последней факторизации и изменения после нее в мультипликативной форме
+// Шермана-Моррисона. Правка элемента, строки или столбца - обновление ранга 1:
+// det(A + u v^T) = det(A) * (1 + v^T A^-1 u), это O(N^2) вместо O(N^3)
+typedef struct {
+    Matrix* matrix;
+    double** lu;
+    int* permutation;
+    int size;
+    int max_threads;
+    int factored;
+
+    ScaledDeterminant determinant;
+
+    // Для i-го обновления: y = A_(i-1)^-1 u, v и alpha = 1 + v^T y
+    double** update_y;
+    double** update_v;
+    double* update_alpha;
+    int update_count;
+    int max_updates;
+
+    double* work_u;
+    double* work_v;
+    int refactor_count;
+} LUUpdater;
+
+LUUpdater* lu_updater_create(const Matrix* matrix, int max_threads);
+void lu_updater_free(LUUpdater* updater);
+
+// Полная факторизация текущей матрицы, сбрасывает накопленные обновления
+int lu_updater_refactor(LUUpdater* updater);
+
+int lu_updater_set(LUUpdater* updater, int row, int col, double value);
+int lu_updater_set_row(LUUpdater* updater, int row, const double* values);
+int lu_updater_set_column(LUUpdater* updater, int col, const double* values);
+
+ScaledDeterminant lu_updater_determinant(const LUUpdater* updater);
+
+// Поток команд (--updates): set I J X, row I X..., col J X..., det, refactor, quit.
+// Индексы с нуля, на каждую команду выводится детерминант
+int lu_update_stream(const Matrix* matrix, int max_threads, FILE* in, FILE* out);
+
+#endif
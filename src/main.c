@@ -2,9 +2,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include "matrix.h"
 #include "determinant.h"
 #include "file_io.h"
+#include "kernels.h"
+#include "batch.h"
+#include "server.h"
+#include "affinity.h"
+#include "benchmark.h"
+#include "trace.h"
+#include "tuning.h"
+#include "determinant_batched.h"
+#include "exact.h"
+#include "lu_update.h"
 
 void print_usage(const char* program_name) {
     printf("=== Программа вычисления детерминанта матрицы (многопоточная версия) ===\n\n");
@@ -14,15 +25,52 @@ void print_usage(const char* program_name) {
     printf("  -t, --threads N    Максимальное количество потоков (по умолчанию: 4)\n");
     printf("  -s, --size N       Размер случайной матрицы NxN (по умолчанию: 5)\n");
     printf("  -r, --range MIN MAX Диапазон значений для случайной матрицы (по умолчанию: -10 10)\n");
+    printf("  -a, --algorithm NAME Алгоритм: gauss (по умолчанию), block, recursive, tiled,\n                       auto (по структуре матрицы: треугольная, блочная,\n                       ленточная, rcm-band), bareiss, modular,\n                       laplace (по определению, N <= 24;\n                       больше - блочное LU с предупреждением)\n");
+    printf("  --kernel NAME      Ядро исключения строк: auto, avx512, avx2, sse2, scalar\n");
     printf("  --save FILE        Сохранить матрицу в файл\n");
     printf("  --create-sample FILE SIZE Создать пример файла матрицы\n");
+    printf("  --binary           Писать --save и --create-sample в двоичном формате (для -f определяется сам)\n");
+    printf("  --batch PATH       Посчитать все матрицы каталога, манифеста или файла с несколькими матрицами\n");
+    printf("  --output FORMAT    Формат вывода пакетного режима: jsonl (по умолчанию) или csv\n");
+    printf("  --batched N COUNT  Пакетное SIMD-ядро для COUNT случайных матриц NxN (N <= 8)\n");
+    printf("  --precision MODE   Точность: double (по умолчанию), float, mixed (float, при большой погрешности - double)\n");
+    printf("  --tolerance X      Допуск оценки погрешности ln|det| для mixed (по умолчанию: 1e-6)\n");
+    printf("  --exact            Дополнительно точный детерминант целочисленной матрицы (Барейс)\n");
+    printf("  --trace FILE       Хронология фаз -a gauss в формате Chrome trace (сборка make TRACE=1)\n");
+    printf("  --trace-counters   Вместе с --trace: аппаратные счетчики perf_event_open по фазам\n");
+    printf("  --tune             Подобрать порог параллельного шага, ширину панели и число потоков, сохранить в %s\n", TUNING_PROFILE_FILE);
+    printf("  --no-profile       Не читать сохраненный профиль, использовать значения по умолчанию\n");
+    printf("  --seed N           Зерно случайных матриц: одна и та же матрица при любом числе потоков\n");
+    printf("  --schedule S       Раздача строк шага исключения: dynamic (своя полоса, затем куски чужих; по умолчанию)\n");
+    printf("                     или static (строго свои полосы, без перераспределения между узлами NUMA)\n");
+    printf("  --pin P            Привязка потоков к ядрам: compact, scatter (по узлам NUMA) или none\n");
+    printf("  --bench            Бенчмарк: прогрев, повторы до 95%% ДИ, медиана, p95, СКО, ГФлоп/с\n");
+    printf("  --bench-sizes LIST Размеры для --bench через запятую (по умолчанию -s или файл -f)\n");
+    printf("  --bench-threads LIST Числа потоков для --bench (по умолчанию 1, 2, 4... до -t)\n");
+    printf("  --warmup N         Прогревочных прогонов на точку (по умолчанию 1)\n");
+    printf("  --repeats MIN MAX  Пределы числа замеров на точку (по умолчанию 5 и 100)\n");
+    printf("  --ci X             Допустимая полуширина 95%% ДИ, доля от среднего (по умолчанию 0.02)\n");
+    printf("  --server SOCKET    Режим сервера: матрицы принимаются через Unix-сокет, ответы в JSON\n");
+    printf("  --query SOCKET FILE Отправить файл с матрицами серверу и напечатать ответ\n");
+    printf("  --updates          Команды со stdin: set I J X | row I X... | col J X... | det | refactor | quit\n");
+    printf("                     (индексы с 0, детерминант пересчитывается за O(N^2))\n");
     printf("  --test             Режим тестирования производительности\n");
     printf("  --format-help      Показать формат файла матрицы\n");
     printf("  -h, --help         Показать эту справку\n\n");
     printf("Примеры:\n");
     printf("  %s -f matrix.txt -t 8          # Загрузить из файла, 8 потоков\n", program_name);
     printf("  %s -s 6 -t 4 --save result.txt # Случайная 6x6, сохранить в файл\n", program_name);
+    printf("  %s -s 2000 -t 8 -a block       # Блочное LU для больших матриц\n", program_name);
     printf("  %s --create-sample test.txt 4  # Создать пример файла 4x4\n", program_name);
+    printf("  %s --create-sample big.bin 4000 --binary # Двоичный файл 4000x4000\n", program_name);
+    printf("  %s --batch ./files -t 4 --output csv # Все матрицы каталога за один запуск\n", program_name);
+    printf("  %s -s 3000 --precision mixed --tolerance 1e-4 # Быстрый float с проверкой\n", program_name);
+    printf("  %s -f matrix.txt --exact       # Точный результат рядом с приближенным\n", program_name);
+    printf("  %s -f big.bin -a modular --exact -t 8 # Точно по модулям простых, КТО\n", program_name);
+    printf("  %s --bench --bench-sizes 500,1000 --bench-threads 1,2,4,8 --output jsonl\n", program_name);
+    printf("  %s --server /tmp/det.sock -t 8 # Долгоживущий процесс для потока запросов\n", program_name);
+    printf("  %s --query /tmp/det.sock matrix.bin # Запрос к запущенному серверу\n", program_name);
+    printf("  %s -f matrix.txt --updates < edits.txt # Детерминант после каждой правки\n", program_name);
     printf("  %s --test                      # Режим тестирования\n", program_name);
 }
 
@@ -39,34 +87,17 @@ void performance_test_with_matrix(const Matrix* matrix, int max_threads) {
 void run_comprehensive_test() {
     printf("\n=== Комплексное тестирование производительности ===\n");
     
-    int sizes[] = {3, 4, 5, 6, 7};
-    int thread_counts[] = {1, 2, 4, 8};
+    static const int sizes[] = {3, 4, 5, 6, 7};
+    static const int thread_counts[] = {1, 2, 4, 8};
     
-    printf("\nРазмер | Потоки | Детерминант | Послед.(с) | Паралл.(с) | Ускорение | Эффект.(%%)\n");
-    printf("-------|--------|-------------|------------|-------------|-----------|----------\n");
+    BenchmarkConfig config;
+    benchmark_config_defaults(&config);
+    config.sizes = sizes;
+    config.size_count = 5;
+    config.threads = thread_counts;
+    config.thread_count = 4;
     
-    for (int s = 0; s < 5; s++) {
-        for (int t = 0; t < 4; t++) {
-            Matrix* matrix = matrix_create(sizes[s]);
-            if (!matrix) continue;
-            
-            matrix_fill_random(matrix, -10, 10);
-            DeterminantResult result = determinant_benchmark(matrix, thread_counts[t]);
-            
-            printf("  %d    |   %d    | %10.2f | %9.6f | %9.6f |   %5.2fx   |  %6.1f%%\n",
-                    sizes[s], thread_counts[t], result.determinant,
-                    result.sequential_time, result.parallel_time,
-                    result.speedup, result.efficiency * 100);
-            
-            matrix_free(matrix);
-            
-            if (s < 4 || t < 3) {
-                printf("Нажмите Enter для продолжения...");
-                getchar();
-            }
-        }
-        printf("-------|--------|-------------|------------|-------------|-----------|----------\n");
-    }
+    benchmark_run(&config, stdout);
 }
 
 int main(int argc, char* argv[]) {
@@ -79,6 +110,30 @@ int main(int argc, char* argv[]) {
     int max_val = 10;
     int sample_size = 4;
     int test_mode = 0;
+    int exact_mode = 0;
+    int update_mode = 0;
+    PrecisionMode precision = PRECISION_DOUBLE;
+    double tolerance = 1e-6;
+    MatrixFileFormat output_format = MATRIX_FORMAT_TEXT;
+    char* batch_path = NULL;
+    int batched_size = 0;
+    int batched_count = 0;
+    BatchOutputFormat batch_format = BATCH_OUTPUT_JSONL;
+    int bench_mode = 0;
+    int output_specified = 0;
+    int* bench_sizes = NULL;
+    int bench_size_count = 0;
+    int* bench_threads = NULL;
+    int bench_thread_count = 0;
+    BenchmarkConfig bench_config;
+    benchmark_config_defaults(&bench_config);
+    int tune_mode = 0;
+    int use_profile = 1;
+    char* trace_file = NULL;
+    int trace_counters = 0;
+    char* server_socket = NULL;
+    char* query_socket = NULL;
+    char* query_file = NULL;
 
     for (int i = 1; i < argc; i++) {
         if ((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--file") == 0) && i + 1 < argc) {
@@ -94,6 +149,20 @@ int main(int argc, char* argv[]) {
             min_val = atoi(argv[i + 1]);
             max_val = atoi(argv[i + 2]);
             i += 2;
+        } else if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--algorithm") == 0) && i + 1 < argc) {
+            if (!determinant_set_algorithm(argv[i + 1])) {
+                printf("Неизвестный алгоритм: %s. Доступны: ", argv[i + 1]);
+                determinant_print_algorithms();
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            if (!kernel_select(argv[i + 1])) {
+                printf("Ядро %s недоступно. Варианты: ", argv[i + 1]);
+                kernel_print_available();
+                return 1;
+            }
+            i++;
         } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
             output_file = argv[i + 1];
             i++;
@@ -101,6 +170,112 @@ int main(int argc, char* argv[]) {
             sample_file = argv[i + 1];
             sample_size = atoi(argv[i + 2]);
             i += 2;
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            output_format = MATRIX_FORMAT_BINARY;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "csv") == 0) {
+                batch_format = BATCH_OUTPUT_CSV;
+            } else if (strcmp(argv[i + 1], "jsonl") == 0) {
+                batch_format = BATCH_OUTPUT_JSONL;
+            } else {
+                printf("Неизвестный формат вывода: %s (jsonl или csv)\n", argv[i + 1]);
+                return 1;
+            }
+            output_specified = 1;
+            i++;
+        } else if (strcmp(argv[i], "--batched") == 0 && i + 2 < argc) {
+            batched_size = atoi(argv[i + 1]);
+            batched_count = atoi(argv[i + 2]);
+            i += 2;
+        } else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "double") == 0) {
+                precision = PRECISION_DOUBLE;
+            } else if (strcmp(argv[i + 1], "float") == 0) {
+                precision = PRECISION_FLOAT;
+            } else if (strcmp(argv[i + 1], "mixed") == 0) {
+                precision = PRECISION_MIXED;
+            } else {
+                printf("Неизвестная точность: %s (double, float или mixed)\n", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench_mode = 1;
+        } else if (strcmp(argv[i], "--bench-sizes") == 0 && i + 1 < argc) {
+            free(bench_sizes);
+            if (!benchmark_parse_list(argv[i + 1], &bench_sizes, &bench_size_count)) {
+                printf("Некорректный список размеров: %s\n", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--bench-threads") == 0 && i + 1 < argc) {
+            free(bench_threads);
+            if (!benchmark_parse_list(argv[i + 1], &bench_threads, &bench_thread_count)) {
+                printf("Некорректный список потоков: %s\n", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            bench_config.warmup = atoi(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 2 < argc) {
+            bench_config.min_repeats = atoi(argv[i + 1]);
+            bench_config.max_repeats = atoi(argv[i + 2]);
+            if (bench_config.min_repeats < 1 || bench_config.max_repeats < bench_config.min_repeats) {
+                printf("Ошибка: нужно 1 <= MIN <= MAX для --repeats\n");
+                return 1;
+            }
+            i += 2;
+        } else if (strcmp(argv[i], "--ci") == 0 && i + 1 < argc) {
+            bench_config.confidence = atof(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--tune") == 0) {
+            tune_mode = 1;
+        } else if (strcmp(argv[i], "--no-profile") == 0) {
+            use_profile = 0;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--trace-counters") == 0) {
+            trace_counters = 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            char* end = NULL;
+            unsigned long long seed = strtoull(argv[i + 1], &end, 10);
+            if (end == argv[i + 1] || *end != '\0') {
+                printf("Некорректное зерно: %s\n", argv[i + 1]);
+                return 1;
+            }
+            matrix_set_random_seed((uint64_t)seed);
+            i++;
+        } else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc) {
+            if (!determinant_set_schedule(argv[i + 1])) {
+                printf("Неизвестная раздача строк: %s (static или dynamic)\n", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            if (!affinity_set_policy(argv[i + 1])) {
+                printf("Неизвестная привязка: %s (compact, scatter или none)\n", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            server_socket = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--query") == 0 && i + 2 < argc) {
+            query_socket = argv[i + 1];
+            query_file = argv[i + 2];
+            i += 2;
+        } else if (strcmp(argv[i], "--updates") == 0) {
+            update_mode = 1;
+        } else if (strcmp(argv[i], "--exact") == 0) {
+            exact_mode = 1;
         } else if (strcmp(argv[i], "--test") == 0) {
             test_mode = 1;
         } else if (strcmp(argv[i], "--format-help") == 0) {
@@ -120,6 +295,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Указатели ядра записываются здесь, пока потоков пула еще нет
+    kernel_init();
+
     if (matrix_size < 1) {
         printf("Ошибка: размер матрицы должен быть от 1\n");
         return 1;
@@ -131,44 +309,159 @@ int main(int argc, char* argv[]) {
     }
 
     if (sample_file) {
-        if (!create_sample_matrix_file(sample_file, sample_size, min_val, max_val)) {
+        if (!create_sample_matrix_file(sample_file, sample_size, min_val, max_val, output_format, max_threads)) {
             printf("Ошибка создания файла\n");
             return 1;
         }
+        printf("Зерно генератора: %llu\n", (unsigned long long)matrix_get_random_seed());
+        return 0;
+    }
+
+    if (batched_size > 0) {
+        batched_benchmark(batched_size, batched_count, max_threads, min_val, max_val);
+        thread_pool_shutdown_shared();
         return 0;
     }
 
+    if (tune_mode) {
+        int ok = tuning_run(max_threads, TUNING_PROFILE_FILE);
+        thread_pool_shutdown_shared();
+        return ok ? 0 : 1;
+    }
+
+    if (use_profile) {
+        tuning_load(TUNING_PROFILE_FILE);
+    }
+
+    if (trace_file) {
+        if (!trace_compiled_in()) {
+            printf("Трассировка не собрана: make clean && make TRACE=1\n");
+            return 1;
+        }
+        trace_enable(trace_counters);
+    }
+
+    if (affinity_get_policy() != AFFINITY_NONE && !query_socket) {
+        affinity_print_report(max_threads);
+    }
+
+    if (query_socket) {
+        return server_query(query_socket, query_file) ? 0 : 1;
+    }
+
+    if (server_socket) {
+        int ok = server_run(server_socket, max_threads);
+        thread_pool_shutdown_shared();
+        return ok ? 0 : 1;
+    }
+
+    if (batch_path) {
+        int ok = batch_run(batch_path, max_threads, batch_format, stdout);
+        thread_pool_shutdown_shared();
+        return ok ? 0 : 1;
+    }
+
+    if (bench_mode) {
+        int default_size = matrix_size;
+        if (bench_size_count == 0) {
+            bench_sizes = &default_size;
+            bench_size_count = 1;
+        }
+        int default_threads[32];
+        if (bench_thread_count == 0) {
+            // 1, 2, 4... и само -t
+            for (int t = 1; t < max_threads && bench_thread_count < 31; t *= 2) {
+                default_threads[bench_thread_count++] = t;
+            }
+            default_threads[bench_thread_count++] = max_threads;
+            bench_threads = default_threads;
+        }
+
+        Matrix* bench_matrix = NULL;
+        if (input_file) {
+            bench_matrix = matrix_read_from_file_threads(input_file, max_threads);
+            if (!bench_matrix) {
+                printf("Не удалось загрузить матрицу из файла\n");
+                return 1;
+            }
+        }
+
+        bench_config.sizes = bench_sizes;
+        bench_config.size_count = bench_size_count;
+        bench_config.threads = bench_threads;
+        bench_config.thread_count = bench_thread_count;
+        bench_config.matrix = bench_matrix;
+        bench_config.min_val = min_val;
+        bench_config.max_val = max_val;
+        if (output_specified) {
+            bench_config.format = batch_format == BATCH_OUTPUT_CSV ? BENCHMARK_OUTPUT_CSV : BENCHMARK_OUTPUT_JSONL;
+        }
+
+        int ok = benchmark_run(&bench_config, stdout);
+        matrix_free(bench_matrix);
+        if (bench_sizes != &default_size) free(bench_sizes);
+        if (bench_threads != default_threads) free(bench_threads);
+        thread_pool_shutdown_shared();
+        return ok ? 0 : 1;
+    }
+
     Matrix* matrix = NULL;
 
     if (input_file) {
-        matrix = matrix_read_from_file(input_file);
+        struct timespec load_start, load_end;
+        clock_gettime(CLOCK_MONOTONIC, &load_start);
+        matrix = matrix_read_from_file_threads(input_file, max_threads);
+        clock_gettime(CLOCK_MONOTONIC, &load_end);
         if (!matrix) {
             printf("Не удалось загрузить матрицу из файла\n");
             return 1;
         }
+        double load_time = (load_end.tv_sec - load_start.tv_sec) + (load_end.tv_nsec - load_start.tv_nsec) / 1e9;
+        printf("Время загрузки: %.9f сек (%.3f мс)\n", load_time, load_time * 1000);
     } else {
-        matrix = matrix_create(matrix_size);
+        matrix = matrix_create_random(matrix_size, min_val, max_val, max_threads);
         if (!matrix) {
             printf("Ошибка создания матрицы\n");
             return 1;
         }
-
-        matrix_fill_random(matrix, min_val, max_val);
+        printf("Зерно генератора: %llu\n", (unsigned long long)matrix_get_random_seed());
     }
 
     if (output_file) {
-        if (!matrix_save_to_file(matrix, output_file)) {
+        if (!matrix_save_to_file_format(matrix, output_file, output_format, max_threads)) {
             printf("Ошибка сохранения матрицы в файл\n");
         }
     }
 
+    if (update_mode) {
+        int ok = lu_update_stream(matrix, max_threads, stdin, stdout);
+        matrix_free(matrix);
+        thread_pool_shutdown_shared();
+        return ok ? 0 : 1;
+    }
+
     if (test_mode) {
         run_comprehensive_test();
+    } else if (precision != PRECISION_DOUBLE) {
+        MixedPrecisionResult mixed = determinant_mixed_precision(matrix, max_threads, precision, tolerance);
+        print_mixed_precision_result(&mixed, precision, tolerance);
+        if (exact_mode) {
+            print_exact_determinant(matrix, max_threads);
+        }
     } else {
         performance_test_with_matrix(matrix, max_threads);
+        if (exact_mode) {
+            print_exact_determinant(matrix, max_threads);
+        }
+    }
+
+    if (trace_file) {
+        trace_print_summary(stdout);
+        trace_write_chrome(trace_file);
     }
 
     matrix_free(matrix);
+    thread_pool_shutdown_shared();
 
     return 0;
 }
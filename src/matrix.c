@@ -1,27 +1,93 @@
+#define _POSIX_C_SOURCE 200112L
 #include "matrix.h"
+#include "thread_pool.h"
 #include <time.h>
 #include <string.h>
+#include <limits.h>
+#include <sys/mman.h>
 
 
-void matrix_fill_random(Matrix* matrix, int min_val, int max_val) {
-    if (!matrix_is_valid(matrix) || min_val >= max_val) {
-        return;
-    }
+static uint64_t random_seed = 0;
+static int random_seeded = 0;
+
+typedef struct {
+    Matrix* matrix;
+    int min_val;
+    int max_val;
+    int clear_padding;
+} RandomFillData;
+
+void matrix_set_random_seed(uint64_t seed) {
+    random_seed = seed;
+    random_seeded = 1;
+}
 
-    static int seeded = 0;
-    if (!seeded) {
-        srand(time(NULL));
-        seeded = 1;
+uint64_t matrix_get_random_seed(void) {
+    if (!random_seeded) {
+        matrix_set_random_seed((uint64_t)time(NULL));
     }
+    return random_seed;
+}
 
-    int range = max_val - min_val;
-    for (int i = 0; i < matrix->size; i++) {
-        for (int j = 0; j < matrix->size; j++) {
-            matrix->data[i][j] = (double)(rand() % range + min_val);
+static uint64_t splitmix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Значение из [min_val, max_val), как прежнее rand() % range + min_val
+double matrix_random_value(uint64_t index, int min_val, int max_val) {
+    uint64_t bits = splitmix64(matrix_get_random_seed() + (index + 1) * 0x9E3779B97F4A7C15ull);
+    uint64_t range = (uint64_t)((int64_t)max_val - min_val);
+    return (double)((int64_t)min_val + (int64_t)(((bits >> 32) * range) >> 32));
+}
+
+static void random_fill_task(void* arg, int thread_index, int thread_count) {
+    RandomFillData* data = (RandomFillData*)arg;
+    Matrix* matrix = data->matrix;
+    int n = matrix->size;
+    int start_row = (int)((int64_t)n * thread_index / thread_count);
+    int end_row = (int)((int64_t)n * (thread_index + 1) / thread_count);
+
+    for (int i = start_row; i < end_row; i++) {
+        double* row = matrix->data[i];
+        for (int j = 0; j < n; j++) {
+            row[j] = matrix_random_value((uint64_t)i * n + j, data->min_val, data->max_val);
         }
+        if (data->clear_padding) {
+            memset(row + n, 0, (size_t)(matrix->stride - n) * sizeof(double));
+        }
+    }
+}
+
+static void random_fill(Matrix* matrix, int min_val, int max_val, int max_threads, int clear_padding) {
+    RandomFillData data;
+    data.matrix = matrix;
+    data.min_val = min_val;
+    data.max_val = max_val;
+    data.clear_padding = clear_padding;
+
+    // Зерно фиксируется до раздачи, чтобы потоки не выбирали его наперегонки
+    matrix_get_random_seed();
+
+    if (max_threads > 1 && (size_t)matrix->size * matrix->size >= MATRIX_PARALLEL_FILL_MIN_ELEMENTS) {
+        thread_pool_run(thread_pool_shared(max_threads), max_threads, random_fill_task, &data);
+    } else {
+        random_fill_task(&data, 0, 1);
     }
 }
 
+void matrix_fill_random_threads(Matrix* matrix, int min_val, int max_val, int max_threads) {
+    if (!matrix_is_valid(matrix) || min_val >= max_val) {
+        return;
+    }
+    random_fill(matrix, min_val, max_val, max_threads, 0);
+}
+
+void matrix_fill_random(Matrix* matrix, int min_val, int max_val) {
+    matrix_fill_random_threads(matrix, min_val, max_val, 1);
+}
+
 void matrix_print(const Matrix* matrix) {
     if (!matrix_is_valid(matrix)) {
         printf("Некорректная матрица\n");
@@ -79,9 +145,11 @@ Matrix* matrix_copy(const Matrix* matrix) {
         return NULL;
     }
 
-    for (int i = 0; i < matrix->size; i++) {
-        for (int j = 0; j < matrix->size; j++) {
-            copy->data[i][j] = matrix->data[i][j];
+    if (matrix->stride == copy->stride) {
+        memcpy(copy->values, matrix->values, (size_t)matrix->size * matrix->stride * sizeof(double));
+    } else {
+        for (int i = 0; i < matrix->size; i++) {
+            memcpy(copy->data[i], matrix->data[i], (size_t)matrix->size * sizeof(double));
         }
     }
 
@@ -92,67 +160,179 @@ int matrix_is_valid(const Matrix* matrix) {
     return matrix != NULL && matrix->data != NULL && matrix->size > 0;
 }
 
-Matrix* matrix_create(int size) {
+int matrix_stride(int size) {
+    int per_line = MATRIX_ALIGNMENT / (int)sizeof(double);
+    return (size + per_line - 1) / per_line * per_line;
+}
+
+static size_t row_table_bytes(int size) {
+    size_t bytes = (size_t)size * sizeof(double*);
+    return (bytes + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+}
+
+double* matrix_data_values(double** data, int size) {
+    return (double*)((char*)data + row_table_bytes(size));
+}
+
+// Один блок: таблица строк, затем выровненные по 64 байта элементы
+double** allocate_matrix_data(int size) {
+    if (size <= 0 || size > INT_MAX - MATRIX_ALIGNMENT) {
+        return NULL;
+    }
+    int stride = matrix_stride(size);
+    size_t table = row_table_bytes(size);
+    if ((size_t)stride > (SIZE_MAX - table) / sizeof(double) / (size_t)size) {
+        return NULL;
+    }
+    size_t bytes = table + (size_t)size * stride * sizeof(double);
+
+    void* block = NULL;
+    if (posix_memalign(&block, MATRIX_ALIGNMENT, bytes) != 0) {
+        return NULL;
+    }
+
+    double** data = (double**)block;
+    double* values = matrix_data_values(data, size);
+    for (int i = 0; i < size; i++) {
+        data[i] = values + (size_t)i * stride;
+    }
+
+    return data;
+}
+
+static Matrix* matrix_allocate(int size) {
+    if (size <= 0) return NULL;
+
     Matrix* matrix = (Matrix*)malloc(sizeof(Matrix));
     if (!matrix) return NULL;
     
     matrix->size = size;
-    matrix->data = (double**)malloc(size * sizeof(double*));
+    matrix->stride = matrix_stride(size);
+    matrix->data = allocate_matrix_data(size);
     if (!matrix->data) {
         free(matrix);
         return NULL;
     }
     
+    matrix->values = matrix_data_values(matrix->data, size);
+    matrix->mapping = NULL;
+    matrix->mapping_length = 0;
+    
+    return matrix;
+}
+
+Matrix* matrix_create(int size) {
+    Matrix* matrix = matrix_allocate(size);
+    if (!matrix) return NULL;
+
+    memset(matrix->values, 0, (size_t)size * matrix->stride * sizeof(double));
+    return matrix;
+}
+
+Matrix* matrix_create_random(int size, int min_val, int max_val, int max_threads) {
+    if (min_val >= max_val) return NULL;
+
+    Matrix* matrix = matrix_allocate(size);
+    if (!matrix) return NULL;
+
+    random_fill(matrix, min_val, max_val, max_threads, 1);
+    return matrix;
+}
+
+Matrix* matrix_wrap_mapping(void* mapping, size_t mapping_length, double* values, int size, int stride) {
+    Matrix* matrix = (Matrix*)malloc(sizeof(Matrix));
+    if (!matrix) return NULL;
+
+    matrix->data = (double**)malloc(size * sizeof(double*));
+    if (!matrix->data) {
+        free(matrix);
+        return NULL;
+    }
+
     for (int i = 0; i < size; i++) {
-        matrix->data[i] = (double*)calloc(size, sizeof(double));
-        if (!matrix->data[i]) {
-            for (int j = 0; j < i; j++) {
-                free(matrix->data[j]);
-            }
-            free(matrix->data);
-            free(matrix);
-            return NULL;
-        }
+        matrix->data[i] = values + (size_t)i * stride;
     }
-    
+
+    matrix->values = values;
+    matrix->size = size;
+    matrix->stride = stride;
+    matrix->mapping = mapping;
+    matrix->mapping_length = mapping_length;
+
     return matrix;
 }
 
 void matrix_free(Matrix* matrix) {
     if (!matrix) return;
-    if (matrix->data) {
-        for (int i = 0; i < matrix->size; i++) {
-            free(matrix->data[i]);
-        }
-        free(matrix->data);
+    free(matrix->data);
+    if (matrix->mapping) {
+        munmap(matrix->mapping, matrix->mapping_length);
     }
     free(matrix);
 }
 
 double** copy_matrix_data(const Matrix* matrix) {
     int n = matrix->size;
-    double** copy = (double**)malloc(n * sizeof(double*));
+    double** copy = allocate_matrix_data(n);
     if (!copy) return NULL;
     
-    for (int i = 0; i < n; i++) {
-        copy[i] = (double*)malloc(n * sizeof(double));
-        if (!copy[i]) {
-            for (int j = 0; j < i; j++) {
-                free(copy[j]);
-            }
-            free(copy);
-            return NULL;
+    if (matrix->stride == matrix_stride(n)) {
+        memcpy(matrix_data_values(copy, n), matrix->values, (size_t)n * matrix->stride * sizeof(double));
+    } else {
+        for (int i = 0; i < n; i++) {
+            memcpy(copy[i], matrix->data[i], (size_t)n * sizeof(double));
+            memset(copy[i] + n, 0, (size_t)(matrix_stride(n) - n) * sizeof(double));
         }
-        memcpy(copy[i], matrix->data[i], n * sizeof(double));
     }
     
     return copy;
 }
 
 void free_matrix_data(double** data, int size) {
-    if (!data) return;
+    (void)size;
+    free(data);
+}
+
+int matrix_float_stride(int size) {
+    int per_line = MATRIX_ALIGNMENT / (int)sizeof(float);
+    return (size + per_line - 1) / per_line * per_line;
+}
+
+MatrixFloat* matrix_float_from_matrix(const Matrix* matrix) {
+    if (!matrix_is_valid(matrix)) {
+        return NULL;
+    }
+
+    int size = matrix->size;
+    int stride = matrix_float_stride(size);
+    size_t table_bytes = ((size_t)size * sizeof(float*) + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+
+    MatrixFloat* result = (MatrixFloat*)malloc(sizeof(MatrixFloat));
+    if (!result) return NULL;
+
+    void* block = NULL;
+    if (posix_memalign(&block, MATRIX_ALIGNMENT, table_bytes + (size_t)size * stride * sizeof(float)) != 0) {
+        free(result);
+        return NULL;
+    }
+
+    result->data = (float**)block;
+    result->values = (float*)((char*)block + table_bytes);
+    result->size = size;
+    result->stride = stride;
+
     for (int i = 0; i < size; i++) {
-        free(data[i]);
+        result->data[i] = result->values + (size_t)i * stride;
+        for (int j = 0; j < size; j++) {
+            result->data[i][j] = (float)matrix->data[i][j];
+        }
     }
-    free(data);
-}
\ No newline at end of file
+
+    return result;
+}
+
+void matrix_float_free(MatrixFloat* matrix) {
+    if (!matrix) return;
+    free(matrix->data);
+    free(matrix);
+}
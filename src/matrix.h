@@ -2,18 +2,51 @@
 #define MATRIX_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#define MATRIX_ALIGNMENT 64
+#define MATRIX_PARALLEL_FILL_MIN_ELEMENTS (1 << 16)
+
+// Элементы лежат в одном выровненном буфере values с ведущей размерностью stride,
+// data - таблица строк в том же блоке памяти (перестановка строк при выборе опорного)
 typedef struct {
     double **data;
+    double *values;
     int size;
+    int stride;
+    void *mapping;
+    size_t mapping_length;
 } Matrix;
 
+// Одинарная точность (--precision float/mixed): та же раскладка, строка выровнена по 64 байта
+typedef struct {
+    float **data;
+    float *values;
+    int size;
+    int stride;
+} MatrixFloat;
+
 Matrix* matrix_create(int size);
 
+int matrix_stride(int size);
+
+// Матрица поверх отображенного файла (values внутри mapping), освобождается через munmap
+Matrix* matrix_wrap_mapping(void* mapping, size_t mapping_length, double* values, int size, int stride);
+
 void matrix_free(Matrix* matrix);
 
+// Случайные элементы - SplitMix64 от зерна и номера i * size + j: матрица зависит только от --seed,
+// а не от числа потоков и порядка заполнения. Без matrix_set_random_seed зерно берется от времени
+void matrix_set_random_seed(uint64_t seed);
+uint64_t matrix_get_random_seed(void);
+double matrix_random_value(uint64_t index, int min_val, int max_val);
+
 void matrix_fill_random(Matrix* matrix, int min_val, int max_val);
+void matrix_fill_random_threads(Matrix* matrix, int min_val, int max_val, int max_threads);
+
+// Память строк впервые трогают заполняющие их потоки, без предварительного обнуления
+Matrix* matrix_create_random(int size, int min_val, int max_val, int max_threads);
 
 void matrix_print(const Matrix* matrix);
 
@@ -21,9 +54,15 @@ Matrix* matrix_create_submatrix(const Matrix* matrix, int exclude_row, int exclu
 
 Matrix* matrix_copy(const Matrix* matrix);
 
+double** allocate_matrix_data(int size);
+double* matrix_data_values(double** data, int size);
 double** copy_matrix_data(const Matrix* matrix);
 void free_matrix_data(double** data, int size);
 
 int matrix_is_valid(const Matrix* matrix);
 
+int matrix_float_stride(int size);
+MatrixFloat* matrix_float_from_matrix(const Matrix* matrix);
+void matrix_float_free(MatrixFloat* matrix);
+
 #endif 
@@ -0,0 +1,594 @@
+#define _DEFAULT_SOURCE
+#include "server.h"
+#include "batch.h"
+#include "determinant.h"
+#include "determinant_batched.h"
+#include "file_io.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Предел размера одного запроса, чтобы один клиент не съел всю память
+#define SERVER_MAX_REQUEST ((size_t)1 << 31)
+
+typedef struct {
+    int fd;
+    char* buffer;
+    size_t length;
+    size_t capacity;
+    char* output;               // ответ копится здесь и отдается неблокирующей записью из цикла poll
+    size_t output_length;
+    size_t output_sent;
+    size_t output_capacity;
+    double accept_time;
+    double ready_time;
+    int ready;
+    int writing;
+} ServerClient;
+
+typedef struct {
+    ServerClient* client;
+    int index;
+    Matrix* matrix;
+    ScaledDeterminant determinant;
+    double start_time;
+    double compute_time;
+    int threads;
+    int batched;
+} ServerJob;
+
+typedef struct {
+    ServerJob** small_jobs;
+    int small_count;
+    int next;
+} ServerDispatch;
+
+static volatile sig_atomic_t server_stop = 0;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void handle_stop_signal(int signal_number) {
+    (void)signal_number;
+    server_stop = 1;
+}
+
+static int set_nonblocking(int fd, int enabled) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return 0;
+    flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+static int write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 1;
+}
+
+static int fill_socket_address(struct sockaddr_un* address, const char* socket_path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address->sun_path)) {
+        printf("Ошибка: слишком длинный путь сокета '%s'\n", socket_path);
+        return 0;
+    }
+    strcpy(address->sun_path, socket_path);
+    return 1;
+}
+
+static void client_close(ServerClient* client) {
+    if (client->fd >= 0) close(client->fd);
+    free(client->buffer);
+    free(client->output);
+    client->fd = -1;
+    client->buffer = NULL;
+    client->length = 0;
+    client->capacity = 0;
+    client->output = NULL;
+    client->output_length = 0;
+    client->output_sent = 0;
+    client->output_capacity = 0;
+    client->writing = 0;
+}
+
+static int client_queue(ServerClient* client, const char* data, size_t length) {
+    if (client->output_length + length > client->output_capacity) {
+        size_t capacity = client->output_capacity ? client->output_capacity : 4096;
+        while (capacity < client->output_length + length) capacity *= 2;
+        char* grown = (char*)realloc(client->output, capacity);
+        if (!grown) return 0;
+        client->output = grown;
+        client->output_capacity = capacity;
+    }
+    memcpy(client->output + client->output_length, data, length);
+    client->output_length += length;
+    return 1;
+}
+
+// Отдает сколько примет сокет; 1 — ответ отправлен целиком, 0 — ждать POLLOUT, -1 — клиент пропал
+static int client_flush(ServerClient* client) {
+    while (client->output_sent < client->output_length) {
+        ssize_t written = write(client->fd, client->output + client->output_sent,
+                                client->output_length - client->output_sent);
+        if (written > 0) {
+            client->output_sent += (size_t)written;
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+    return 1;
+}
+
+// Ответ собран: дальше соединение ждет только записи и закрывается после нее
+static void client_finish(ServerClient* client) {
+    client->ready = 1;
+    client->writing = 1;
+    if (client_flush(client) != 0) {
+        client_close(client);
+    }
+}
+
+// Дочитывает доступные данные; 1 — EOF (запрос целиком), 0 — ждать еще, -1 — ошибка
+static int client_read(ServerClient* client) {
+    for (;;) {
+        if (client->length == client->capacity) {
+            size_t capacity = client->capacity ? client->capacity * 2 : 65536;
+            if (capacity > SERVER_MAX_REQUEST) return -1;
+            char* grown = (char*)realloc(client->buffer, capacity);
+            if (!grown) return -1;
+            client->buffer = grown;
+            client->capacity = capacity;
+        }
+
+        ssize_t received = read(client->fd, client->buffer + client->length, client->capacity - client->length);
+        if (received > 0) {
+            client->length += (size_t)received;
+        } else if (received == 0) {
+            return 1;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+}
+
+static void small_jobs_task(void* arg, int thread_index, int thread_count) {
+    ServerDispatch* dispatch = (ServerDispatch*)arg;
+    (void)thread_index;
+    (void)thread_count;
+
+    for (;;) {
+        int k = __atomic_fetch_add(&dispatch->next, 1, __ATOMIC_RELAXED);
+        if (k >= dispatch->small_count) break;
+        ServerJob* job = dispatch->small_jobs[k];
+        job->start_time = now_seconds();
+        job->determinant = determinant_get_algorithm()->function(job->matrix, 1);
+        job->compute_time = now_seconds() - job->start_time;
+        job->threads = 1;
+    }
+}
+
+static size_t format_response(char* buffer, size_t size, const ServerJob* job, int batch_size) {
+    int sign = scaled_determinant_sign(&job->determinant);
+    double log_abs = scaled_determinant_log(&job->determinant);
+    double value = scaled_determinant_value(&job->determinant);
+    char log_text[32] = "null";
+    char value_text[32] = "null";
+
+    if (!isinf(log_abs)) snprintf(log_text, sizeof(log_text), "%.17g", log_abs);
+    if (isfinite(value)) snprintf(value_text, sizeof(value_text), "%.17g", value);
+
+    double queue_time = job->start_time - job->client->ready_time;
+    double latency = now_seconds() - job->client->accept_time;
+    int written = snprintf(buffer, size,
+        "{\"index\":%d,\"size\":%d,\"status\":\"ok\",\"sign\":%d,\"log_abs_determinant\":%s,\"determinant\":%s,"
+        "\"queue_time\":%.9f,\"time\":%.9f,\"latency\":%.9f,\"threads\":%d,\"batch\":%d,\"mode\":\"%s\"}\n",
+        job->index, job->matrix->size, sign, log_text, value_text,
+        queue_time, job->compute_time, latency, job->threads, job->threads > 1 ? 1 : batch_size,
+        job->batched ? "batched" : (job->threads > 1 ? "intra" : "inter"));
+    return written > 0 ? (size_t)written : 0;
+}
+
+static void respond_error(ServerClient* client, const char* message) {
+    char buffer[256];
+    double latency = now_seconds() - client->accept_time;
+    int written = snprintf(buffer, sizeof(buffer), "{\"status\":\"error\",\"message\":\"%s\",\"latency\":%.9f}\n",
+                           message, latency);
+    if (written > 0) client_queue(client, buffer, (size_t)written);
+    client_finish(client);
+}
+
+static int process_batched(ServerJob* jobs, int job_count, int max_threads) {
+    Matrix** matrices = (Matrix**)malloc(job_count * sizeof(Matrix*));
+    ScaledDeterminant* results = (ScaledDeterminant*)malloc(job_count * sizeof(ScaledDeterminant));
+    int* done = (int*)calloc(job_count, sizeof(int));
+    int computed = 0;
+
+    if (matrices && results && done) {
+        for (int i = 0; i < job_count; i++) {
+            matrices[i] = jobs[i].matrix->size <= BATCHED_MAX_SIZE ? jobs[i].matrix : NULL;
+        }
+        double start = now_seconds();
+        computed = determinant_batched_matrices(matrices, job_count, results, done, max_threads);
+        double per_matrix = computed > 0 ? (now_seconds() - start) / computed : 0.0;
+
+        for (int i = 0; i < job_count; i++) {
+            if (!done[i]) continue;
+            jobs[i].start_time = start;
+            jobs[i].compute_time = per_matrix;
+            jobs[i].determinant = results[i];
+            jobs[i].threads = 1;
+            jobs[i].batched = 1;
+        }
+    }
+
+    free(matrices);
+    free(results);
+    free(done);
+    return computed;
+}
+
+// Все готовые запросы: разбор, одна раздача пула на маленькие матрицы, затем большие целиком
+static long process_ready(ServerClient* clients, int client_count, int max_threads) {
+    ServerJob* jobs = NULL;
+    int job_count = 0;
+    int job_capacity = 0;
+
+    for (int c = 0; c < client_count; c++) {
+        ServerClient* client = &clients[c];
+        if (client->fd < 0 || !client->ready || client->writing) continue;
+
+        Matrix** matrices = NULL;
+        int count = 0;
+        int parsed = matrix_parse_collection(client->buffer, client->length, &matrices, &count, "запрос",
+                                             SERVER_MAX_MATRIX_SIZE);
+        if (!parsed || count == 0) {
+            char message[128];
+            snprintf(message, sizeof(message), "не удалось разобрать матрицу (размер от 1 до %d)",
+                     SERVER_MAX_MATRIX_SIZE);
+            respond_error(client, parsed ? "пустой запрос" : message);
+            continue;
+        }
+
+        if (job_count + count > job_capacity) {
+            int capacity = job_capacity ? job_capacity : 64;
+            while (capacity < job_count + count) capacity *= 2;
+            ServerJob* grown = (ServerJob*)realloc(jobs, capacity * sizeof(ServerJob));
+            if (!grown) {
+                for (int i = 0; i < count; i++) matrix_free(matrices[i]);
+                free(matrices);
+                respond_error(client, "недостаточно памяти");
+                continue;
+            }
+            jobs = grown;
+            job_capacity = capacity;
+        }
+
+        for (int i = 0; i < count; i++) {
+            ServerJob* job = &jobs[job_count++];
+            memset(job, 0, sizeof(*job));
+            job->client = client;
+            job->index = i;
+            job->matrix = matrices[i];
+        }
+        free(matrices);
+        free(client->buffer);
+        client->buffer = NULL;
+        client->length = 0;
+        client->capacity = 0;
+    }
+
+    if (job_count == 0) {
+        free(jobs);
+        return 0;
+    }
+
+    // N <= BATCHED_MAX_SIZE при -a gauss: всем пришедшим сразу - пакетное ядро по группам одного размера
+    int batched_count = 0;
+    if (determinant_batched_applies()) {
+        batched_count = process_batched(jobs, job_count, max_threads);
+    }
+
+    ServerDispatch dispatch;
+    dispatch.small_jobs = (ServerJob**)malloc(job_count * sizeof(ServerJob*));
+    dispatch.small_count = 0;
+    dispatch.next = 0;
+
+    if (dispatch.small_jobs) {
+        for (int i = 0; i < job_count; i++) {
+            if (jobs[i].batched) continue;
+            if (jobs[i].matrix->size < BATCH_LARGE_SIZE || max_threads == 1) {
+                dispatch.small_jobs[dispatch.small_count++] = &jobs[i];
+            }
+        }
+        if (dispatch.small_count > 0) {
+            int threads = dispatch.small_count < max_threads ? dispatch.small_count : max_threads;
+            thread_pool_run(thread_pool_shared(max_threads), threads, small_jobs_task, &dispatch);
+        }
+    }
+
+    for (int i = 0; i < job_count; i++) {
+        ServerJob* job = &jobs[i];
+        if (job->threads == 0) {
+            job->start_time = now_seconds();
+            job->determinant = determinant_get_algorithm()->function(job->matrix, max_threads);
+            job->compute_time = now_seconds() - job->start_time;
+            job->threads = max_threads;
+        }
+    }
+
+    // Ответы по соединениям: задания одного клиента идут подряд
+    char response[512];
+    for (int i = 0; i < job_count; i++) {
+        ServerJob* job = &jobs[i];
+        ServerClient* client = job->client;
+        size_t length = format_response(response, sizeof(response), job,
+                                        job->batched ? batched_count : dispatch.small_count);
+        client_queue(client, response, length);
+        matrix_free(job->matrix);
+        if (i + 1 == job_count || jobs[i + 1].client != client) {
+            client_finish(client);
+        }
+    }
+
+    free(dispatch.small_jobs);
+    free(jobs);
+    return job_count;
+}
+
+static int open_listen_socket(const char* socket_path) {
+    struct sockaddr_un address;
+    if (!fill_socket_address(&address, socket_path)) return -1;
+
+    // Сокет от прошлого запуска мешает bind; обычные файлы не трогаем
+    struct stat info;
+    if (lstat(socket_path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(socket_path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        printf("Ошибка создания сокета: %s\n", strerror(errno));
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        printf("Ошибка: не удалось слушать '%s': %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    set_nonblocking(fd, 1);
+    return fd;
+}
+
+int server_run(const char* socket_path, int max_threads) {
+    int listen_fd = open_listen_socket(socket_path);
+    if (listen_fd < 0) return 0;
+
+    ServerClient* clients = (ServerClient*)calloc(SERVER_MAX_CLIENTS, sizeof(ServerClient));
+    struct pollfd* fds = (struct pollfd*)malloc((SERVER_MAX_CLIENTS + 1) * sizeof(struct pollfd));
+    int* fd_client = (int*)malloc((SERVER_MAX_CLIENTS + 1) * sizeof(int));
+    if (!clients || !fds || !fd_client) {
+        free(clients);
+        free(fds);
+        free(fd_client);
+        close(listen_fd);
+        unlink(socket_path);
+        return 0;
+    }
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Потоки пула создаются один раз и живут все время работы сервера
+    thread_pool_shared(max_threads);
+
+    printf("Сервер слушает %s (потоков: %d, алгоритм: %s)\n", socket_path, max_threads, determinant_get_algorithm()->name);
+    fflush(stdout);
+
+    long served = 0;
+    long dispatches = 0;
+
+    while (!server_stop) {
+        int open_clients = 0;
+        for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) open_clients++;
+        }
+
+        int nfds = 0;
+        if (open_clients < SERVER_MAX_CLIENTS) {
+            fds[nfds].fd = listen_fd;
+            fds[nfds].events = POLLIN;
+            fd_client[nfds] = -1;
+            nfds++;
+        }
+        // Клиент, не забирающий ответ, ждет POLLOUT и не задерживает остальных
+        for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0 && (!clients[i].ready || clients[i].writing)) {
+                fds[nfds].fd = clients[i].fd;
+                fds[nfds].events = clients[i].writing ? POLLOUT : POLLIN;
+                fd_client[nfds] = i;
+                nfds++;
+            }
+        }
+
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            printf("Ошибка poll: %s\n", strerror(errno));
+            break;
+        }
+
+        int ready_count = 0;
+        for (int k = 0; k < nfds; k++) {
+            if (!fds[k].revents) continue;
+
+            if (fd_client[k] < 0) {
+                // Принимаем всех ожидающих: они попадут в одну раздачу
+                while (open_clients < SERVER_MAX_CLIENTS) {
+                    int fd = accept(listen_fd, NULL, NULL);
+                    if (fd < 0) break;
+                    int slot = 0;
+                    while (clients[slot].fd >= 0) slot++;
+                    set_nonblocking(fd, 1);
+                    memset(&clients[slot], 0, sizeof(ServerClient));
+                    clients[slot].fd = fd;
+                    clients[slot].accept_time = now_seconds();
+                    open_clients++;
+
+                    int status = client_read(&clients[slot]);
+                    if (status < 0) {
+                        client_close(&clients[slot]);
+                        open_clients--;
+                    } else if (status > 0) {
+                        clients[slot].ready = 1;
+                        clients[slot].ready_time = now_seconds();
+                        ready_count++;
+                    }
+                }
+                continue;
+            }
+
+            ServerClient* client = &clients[fd_client[k]];
+            if (client->writing) {
+                if (client_flush(client) != 0) {
+                    client_close(client);
+                }
+                continue;
+            }
+
+            int status = client_read(client);
+            if (status < 0) {
+                respond_error(client, "ошибка чтения запроса");
+            } else if (status > 0) {
+                client->ready = 1;
+                client->ready_time = now_seconds();
+                ready_count++;
+            }
+        }
+
+        if (ready_count > 0) {
+            served += process_ready(clients, SERVER_MAX_CLIENTS, max_threads);
+            dispatches++;
+        }
+    }
+
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        client_close(&clients[i]);
+    }
+    free(clients);
+    free(fds);
+    free(fd_client);
+    close(listen_fd);
+    unlink(socket_path);
+
+    printf("Сервер остановлен: матриц %ld, раздач %ld\n", served, dispatches);
+    return 1;
+}
+
+static char* read_all(int fd, size_t* length) {
+    size_t capacity = 65536;
+    char* buffer = (char*)malloc(capacity);
+    *length = 0;
+    while (buffer) {
+        if (*length == capacity) {
+            capacity *= 2;
+            char* grown = (char*)realloc(buffer, capacity);
+            if (!grown) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = grown;
+        }
+        ssize_t received = read(fd, buffer + *length, capacity - *length);
+        if (received == 0) break;
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            free(buffer);
+            return NULL;
+        }
+        *length += (size_t)received;
+    }
+    return buffer;
+}
+
+int server_query(const char* socket_path, const char* filename) {
+    int input = strcmp(filename, "-") == 0 ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (input < 0) {
+        printf("Ошибка: не удалось открыть файл '%s'\n", filename);
+        return 0;
+    }
+    size_t length = 0;
+    char* request = read_all(input, &length);
+    if (input != STDIN_FILENO) close(input);
+    if (!request) {
+        printf("Ошибка чтения файла '%s'\n", filename);
+        return 0;
+    }
+
+    struct sockaddr_un address;
+    int fd = fill_socket_address(&address, socket_path) ? socket(AF_UNIX, SOCK_STREAM, 0) : -1;
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        printf("Ошибка: сервер '%s' недоступен: %s\n", socket_path, strerror(errno));
+        if (fd >= 0) close(fd);
+        free(request);
+        return 0;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    double start = now_seconds();
+    int ok = write_all(fd, request, length);
+    free(request);
+    shutdown(fd, SHUT_WR);
+
+    size_t response_length = 0;
+    char* response = ok ? read_all(fd, &response_length) : NULL;
+    close(fd);
+    double round_trip = now_seconds() - start;
+
+    if (!response) {
+        printf("Ошибка обмена с сервером '%s'\n", socket_path);
+        return 0;
+    }
+    fwrite(response, 1, response_length, stdout);
+    fprintf(stderr, "Время запроса: %.3f мс\n", round_trip * 1000);
+
+    ok = response_length > 0 && strstr(response, "\"status\":\"error\"") == NULL;
+    free(response);
+    return ok;
+}
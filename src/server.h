@@ -0,0 +1,19 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+// Предел одновременно открытых соединений сервера
+#define SERVER_MAX_CLIENTS 1024
+
+// Предел размера матрицы в запросе: больший N отклоняется до выделения памяти
+#define SERVER_MAX_MATRIX_SIZE 8192
+
+// Запрос: одно соединение, клиент пишет матрицы (текст или двоичный формат) и закрывает запись,
+// ответ — строка JSON на каждую матрицу. Одновременно пришедшие маленькие матрицы
+// считаются одной раздачей пула (каждая выбранным -a алгоритмом на одном потоке),
+// большие — по одной всеми потоками, N <= 8 при -a gauss — пакетным ядром. Ответы отдаются неблокирующей записью из цикла poll
+int server_run(const char* socket_path, int max_threads);
+
+// Клиент: отправить файл ("-" — stdin) на сокет и напечатать ответ
+int server_query(const char* socket_path, const char* filename);
+
+#endif
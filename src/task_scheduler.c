@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "task_scheduler.h"
+#include "thread_pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#define TASK_DEQUE_CAPACITY 1024
+#define IDLE_SPINS_BEFORE_YIELD 64
+
+typedef struct {
+    SchedulerTask function;
+    void* arg;
+    TaskGroup* group;
+} ScheduledTask;
+
+// Кольцевой буфер: head - сторона воров, tail - сторона владельца
+typedef struct {
+    pthread_mutex_t mutex;
+    unsigned head;
+    unsigned tail;
+    ScheduledTask tasks[TASK_DEQUE_CAPACITY];
+} TaskDeque;
+
+// Состояние одного запуска: одновременные task_scheduler_run (из задач пакета или сервера) не мешают друг другу
+typedef struct {
+    SchedulerTask root;
+    void* arg;
+    int done;
+    TaskDeque* deques;
+    int deque_count;
+} SchedulerRun;
+
+static __thread SchedulerRun* current_run = NULL;
+static __thread int worker_index = -1;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+void task_group_init(TaskGroup* group) {
+    group->pending = 0;
+}
+
+static void execute_task(const ScheduledTask* task) {
+    task->function(task->arg);
+    __atomic_sub_fetch(&task->group->pending, 1, __ATOMIC_RELEASE);
+}
+
+void task_spawn(TaskGroup* group, SchedulerTask function, void* arg) {
+    // Вне планировщика или при полной очереди задача выполняется сразу
+    if (worker_index < 0) {
+        function(arg);
+        return;
+    }
+
+    TaskDeque* deque = &current_run->deques[worker_index];
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->tail - deque->head >= TASK_DEQUE_CAPACITY) {
+        pthread_mutex_unlock(&deque->mutex);
+        function(arg);
+        return;
+    }
+    ScheduledTask* slot = &deque->tasks[deque->tail % TASK_DEQUE_CAPACITY];
+    slot->function = function;
+    slot->arg = arg;
+    slot->group = group;
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+    deque->tail++;
+    pthread_mutex_unlock(&deque->mutex);
+}
+
+static int pop_own_task(ScheduledTask* task) {
+    TaskDeque* deque = &current_run->deques[worker_index];
+    int found = 0;
+
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->tail != deque->head) {
+        deque->tail--;
+        *task = deque->tasks[deque->tail % TASK_DEQUE_CAPACITY];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return found;
+}
+
+static int steal_task(ScheduledTask* task) {
+    int deque_count = current_run->deque_count;
+    for (int i = 1; i < deque_count; i++) {
+        TaskDeque* victim = &current_run->deques[(worker_index + i) % deque_count];
+
+        // Пустые очереди проверяются без блокировки
+        if (__atomic_load_n(&victim->tail, __ATOMIC_RELAXED) ==
+            __atomic_load_n(&victim->head, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        int found = 0;
+        pthread_mutex_lock(&victim->mutex);
+        if (victim->tail != victim->head) {
+            *task = victim->tasks[victim->head % TASK_DEQUE_CAPACITY];
+            victim->head++;
+            found = 1;
+        }
+        pthread_mutex_unlock(&victim->mutex);
+        if (found) return 1;
+    }
+    return 0;
+}
+
+static int run_one_task(void) {
+    ScheduledTask task;
+    if (pop_own_task(&task) || steal_task(&task)) {
+        execute_task(&task);
+        return 1;
+    }
+    return 0;
+}
+
+static void idle_wait(int* idle_spins) {
+    if (++*idle_spins < IDLE_SPINS_BEFORE_YIELD) {
+        cpu_relax();
+    } else {
+        // Потоков может быть больше, чем ядер: уступаем процессор тем, у кого есть работа
+        sched_yield();
+    }
+}
+
+void task_wait(TaskGroup* group) {
+    int idle_spins = 0;
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        if (worker_index >= 0 && run_one_task()) {
+            idle_spins = 0;
+        } else {
+            idle_wait(&idle_spins);
+        }
+    }
+}
+
+static void scheduler_worker_task(void* arg, int thread_index, int thread_count) {
+    SchedulerRun* run = (SchedulerRun*)arg;
+    (void)thread_count;
+
+    current_run = run;
+    worker_index = thread_index;
+
+    if (thread_index == 0) {
+        run->root(run->arg);
+        __atomic_store_n(&run->done, 1, __ATOMIC_RELEASE);
+    } else {
+        int idle_spins = 0;
+        while (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE)) {
+            if (run_one_task()) {
+                idle_spins = 0;
+            } else {
+                idle_wait(&idle_spins);
+            }
+        }
+    }
+
+    worker_index = -1;
+    current_run = NULL;
+}
+
+void task_scheduler_run(int max_threads, SchedulerTask root, void* arg) {
+    if (max_threads < 1) max_threads = 1;
+
+    // Вложенный запуск: задачи пойдут в очереди уже работающего планировщика
+    if (worker_index >= 0) {
+        root(arg);
+        return;
+    }
+
+    ThreadPool* pool = thread_pool_shared(max_threads);
+    int thread_count = pool ? pool->size : 1;
+    if (thread_count > max_threads) thread_count = max_threads;
+
+    SchedulerRun run;
+    run.root = root;
+    run.arg = arg;
+    run.done = 0;
+    run.deques = (TaskDeque*)malloc(thread_count * sizeof(TaskDeque));
+    run.deque_count = thread_count;
+    if (!run.deques) {
+        // Без очередей все порождаемые задачи выполняются сразу на вызывающем потоке
+        root(arg);
+        return;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_mutex_init(&run.deques[i].mutex, NULL);
+        run.deques[i].head = 0;
+        run.deques[i].tail = 0;
+    }
+
+    thread_pool_run(pool, thread_count, scheduler_worker_task, &run);
+
+    for (int i = 0; i < thread_count; i++) {
+        pthread_mutex_destroy(&run.deques[i].mutex);
+    }
+    free(run.deques);
+}
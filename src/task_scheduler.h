@@ -0,0 +1,25 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+// Планировщик задач с перехватом работы (work stealing) поверх потоков общего пула.
+// У каждого потока своя очередь: свои задачи берутся с конца (LIFO),
+// чужие перехватываются с начала (FIFO), поэтому воруются самые крупные куски
+typedef void (*SchedulerTask)(void* arg);
+
+// Счетчик незавершенных дочерних задач
+typedef struct {
+    int pending;
+} TaskGroup;
+
+void task_group_init(TaskGroup* group);
+
+// arg должен жить до task_wait(group): обычно это переменная на стеке порождающей задачи
+void task_spawn(TaskGroup* group, SchedulerTask function, void* arg);
+
+// Ожидание с помощью: пока группа не завершена, поток выполняет свои и чужие задачи
+void task_wait(TaskGroup* group);
+
+// root выполняется вызывающим потоком, остальные max_threads - 1 потоков пула перехватывают задачи
+void task_scheduler_run(int max_threads, SchedulerTask root, void* arg);
+
+#endif
@@ -0,0 +1,213 @@
+#include "thread_pool.h"
+#include "affinity.h"
+#include <stdlib.h>
+
+#define SPIN_ITERATIONS 4000
+
+typedef struct {
+    ThreadPool* pool;
+    int index;
+} WorkerStart;
+
+static ThreadPool* shared_pool = NULL;
+static pthread_mutex_t shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread int inside_pool_task = 0;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void* worker_main(void* arg) {
+    WorkerStart* start = (WorkerStart*)arg;
+    ThreadPool* pool = start->pool;
+    int index = start->index;
+    free(start);
+
+    unsigned long seen = 0;
+    int spin = 1;
+    inside_pool_task = 1;
+    affinity_pin_current(index);
+
+    for (;;) {
+        // Короткое ожидание активным опросом: шаги исключения идут подряд.
+        // Поток, не попавший в прошлый запуск (пул больше запрошенного), сразу спит
+        for (int i = 0; spin && i < SPIN_ITERATIONS; i++) {
+            if (__atomic_load_n(&pool->epoch, __ATOMIC_ACQUIRE) != seen ||
+                __atomic_load_n(&pool->shutdown, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            cpu_relax();
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->epoch == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start_cond, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->epoch;
+        int active = pool->active;
+        ThreadPoolTask task = pool->task;
+        void* task_arg = pool->arg;
+        pthread_mutex_unlock(&pool->mutex);
+
+        spin = index < active;
+        if (!spin) {
+            continue;
+        }
+
+        task(task_arg, index, active);
+
+        if (__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+            pthread_mutex_lock(&pool->mutex);
+            pthread_cond_signal(&pool->done_cond);
+            pthread_mutex_unlock(&pool->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+ThreadPool* thread_pool_create(int num_threads) {
+    if (num_threads < 1) {
+        return NULL;
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->size = num_threads;
+    pool->threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_mutex_init(&pool->run_mutex, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    // Поток 0 - вызывающий, поэтому рабочих создается на один меньше
+    affinity_pin_current(0);
+    for (int i = 1; i < num_threads; i++) {
+        WorkerStart* start = (WorkerStart*)malloc(sizeof(WorkerStart));
+        if (!start) {
+            pool->size = i;
+            break;
+        }
+        start->pool = pool;
+        start->index = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, start) != 0) {
+            free(start);
+            pool->size = i;
+            break;
+        }
+    }
+
+    return pool;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    __atomic_store_n(&pool->shutdown, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 1; i < pool->size; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->run_mutex);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->threads);
+    free(pool);
+}
+
+void thread_pool_run(ThreadPool* pool, int thread_count, ThreadPoolTask task, void* arg) {
+    if (!task) return;
+
+    // Вложенный вызов из задачи пула выполняется на текущем потоке
+    if (!pool || inside_pool_task || thread_count <= 1 || pool->size <= 1) {
+        task(arg, 0, 1);
+        return;
+    }
+
+    if (thread_count > pool->size) {
+        thread_count = pool->size;
+    }
+
+    pthread_mutex_lock(&pool->run_mutex);
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->arg = arg;
+    pool->active = thread_count;
+    __atomic_store_n(&pool->pending, thread_count - 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool->epoch, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    inside_pool_task = 1;
+    task(arg, 0, thread_count);
+    inside_pool_task = 0;
+
+    for (int i = 0; i < SPIN_ITERATIONS; i++) {
+        if (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) == 0) {
+            pthread_mutex_unlock(&pool->run_mutex);
+            return;
+        }
+        cpu_relax();
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    while (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) != 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->run_mutex);
+}
+
+ThreadPool* thread_pool_shared(int num_threads) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    // Из задачи пула пул не меняется: вложенные запуски все равно идут на текущем потоке
+    if (inside_pool_task) {
+        return __atomic_load_n(&shared_pool, __ATOMIC_ACQUIRE);
+    }
+
+    pthread_mutex_lock(&shared_mutex);
+    if (!shared_pool || shared_pool->size < num_threads) {
+        ThreadPool* pool = thread_pool_create(num_threads);
+        if (pool) {
+            pool->retired = shared_pool;
+            __atomic_store_n(&shared_pool, pool, __ATOMIC_RELEASE);
+        }
+    }
+    ThreadPool* pool = shared_pool;
+    pthread_mutex_unlock(&shared_mutex);
+
+    return pool;
+}
+
+void thread_pool_shutdown_shared(void) {
+    pthread_mutex_lock(&shared_mutex);
+    ThreadPool* pool = shared_pool;
+    shared_pool = NULL;
+    pthread_mutex_unlock(&shared_mutex);
+
+    while (pool) {
+        ThreadPool* retired = pool->retired;
+        thread_pool_destroy(pool);
+        pool = retired;
+    }
+}
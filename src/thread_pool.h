@@ -0,0 +1,38 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+// Задача пула: вызывается на каждом участвующем потоке,
+// thread_index = 0 всегда выполняется вызывающим потоком
+typedef void (*ThreadPoolTask)(void* arg, int thread_index, int thread_count);
+
+typedef struct ThreadPool {
+    pthread_t* threads;
+    int size;
+    pthread_mutex_t mutex;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    unsigned long epoch;
+    int pending;
+    int active;
+    int shutdown;
+    ThreadPoolTask task;
+    void* arg;
+    pthread_mutex_t run_mutex;          // один запуск за раз от внешних потоков
+    struct ThreadPool* retired;         // вытесненные общие пулы, живут до thread_pool_shutdown_shared
+} ThreadPool;
+
+ThreadPool* thread_pool_create(int num_threads);
+void thread_pool_destroy(ThreadPool* pool);
+
+void thread_pool_run(ThreadPool* pool, int thread_count, ThreadPoolTask task, void* arg);
+
+// Общий пул процесса: создается при первом обращении и только растет - при запросе большего размера
+// создается новый, а старый откладывается до thread_pool_shutdown_shared, чтобы его указатели
+// оставались рабочими. Изнутри задачи пула возвращается текущий пул без изменений.
+// Число потоков задается в thread_pool_run и ограничивается размером пула
+ThreadPool* thread_pool_shared(int num_threads);
+void thread_pool_shutdown_shared(void);
+
+#endif
@@ -0,0 +1,341 @@
+#define _GNU_SOURCE
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint64_t counters[TRACE_COUNTER_COUNT];
+    int phase;
+    int column;
+} TraceEvent;
+
+// Буфер пишет только свой поток; выравнивание против ложного разделения строк кэша
+typedef struct {
+    TraceEvent* events;
+    long dropped;
+    int count;
+    int perf_fd;                // 0 - не открывался, -1 - недоступен
+    char padding[64 - sizeof(TraceEvent*) - sizeof(long) - 2 * sizeof(int)];
+} TraceBuffer;
+
+int trace_enabled = 0;
+
+static TraceBuffer buffers[TRACE_MAX_THREADS] __attribute__((aligned(64)));
+static int use_hardware_counters = 0;
+static uint64_t origin_ticks;
+static double origin_ns;
+
+static const char* phase_names[TRACE_PHASE_COUNT] = {"pivot", "swap", "dispatch", "eliminate"};
+static const char* counter_names[TRACE_COUNTER_COUNT] = {"cycles", "instructions", "cache_misses"};
+
+static double monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// rdtsc на x86: десятки тактов против сотни у clock_gettime
+static inline uint64_t trace_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)monotonic_ns();
+#endif
+}
+
+// Тактов на наносекунду: по отрезку от trace_enable до момента отчета
+static double ticks_per_ns(void) {
+    double elapsed = monotonic_ns() - origin_ns;
+    uint64_t ticks = trace_ticks() - origin_ticks;
+    return elapsed > 0.0 && ticks > 0 ? (double)ticks / elapsed : 1.0;
+}
+
+int trace_compiled_in(void) {
+#ifdef DET_TRACE
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void trace_enable(int hardware_counters) {
+    use_hardware_counters = hardware_counters;
+    origin_ns = monotonic_ns();
+    origin_ticks = trace_ticks();
+    trace_enabled = 1;
+}
+
+#ifdef __linux__
+static int open_counter(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+// Группа счетчиков открывается на самом потоке: perf_event_open с pid = 0 считает только вызывающий поток
+static void open_thread_counters(TraceBuffer* buffer) {
+    buffer->perf_fd = -1;
+#ifdef __linux__
+    int leader = open_counter(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (leader < 0) return;
+    if (open_counter(PERF_COUNT_HW_INSTRUCTIONS, leader) < 0 ||
+        open_counter(PERF_COUNT_HW_CACHE_MISSES, leader) < 0) {
+        close(leader);
+        return;
+    }
+    buffer->perf_fd = leader;
+#endif
+}
+
+static void read_counters(TraceBuffer* buffer, uint64_t* counters) {
+    if (buffer->perf_fd == 0) {
+        open_thread_counters(buffer);
+    }
+    if (buffer->perf_fd < 0) return;
+
+    uint64_t values[1 + TRACE_COUNTER_COUNT];
+    if (read(buffer->perf_fd, values, sizeof(values)) == (ssize_t)sizeof(values)) {
+        memcpy(counters, values + 1, sizeof(uint64_t) * TRACE_COUNTER_COUNT);
+    }
+}
+
+void trace_span_begin(TraceSpan* span, int thread) {
+    if (use_hardware_counters && thread >= 0 && thread < TRACE_MAX_THREADS) {
+        read_counters(&buffers[thread], span->counters);
+    }
+    span->start = trace_ticks();
+}
+
+void trace_span_end(const TraceSpan* span, int thread, TracePhase phase, int column) {
+    uint64_t end = trace_ticks();
+    if (thread < 0 || thread >= TRACE_MAX_THREADS) return;
+
+    TraceBuffer* buffer = &buffers[thread];
+    if (!buffer->events) {
+        buffer->events = (TraceEvent*)malloc(TRACE_EVENTS_PER_THREAD * sizeof(TraceEvent));
+        if (!buffer->events) {
+            buffer->dropped++;
+            return;
+        }
+    }
+    if (buffer->count == TRACE_EVENTS_PER_THREAD) {
+        buffer->dropped++;
+        return;
+    }
+
+    TraceEvent* event = &buffer->events[buffer->count++];
+    event->start = span->start;
+    event->end = end;
+    event->phase = phase;
+    event->column = column;
+    memset(event->counters, 0, sizeof(event->counters));
+    if (use_hardware_counters && buffer->perf_fd > 0) {
+        uint64_t counters[TRACE_COUNTER_COUNT] = {0};
+        read_counters(buffer, counters);
+        for (int k = 0; k < TRACE_COUNTER_COUNT; k++) {
+            event->counters[k] = counters[k] - span->counters[k];
+        }
+    }
+}
+
+static int column_limit(void) {
+    int limit = 0;
+    for (int t = 0; t < TRACE_MAX_THREADS; t++) {
+        for (int i = 0; i < buffers[t].count; i++) {
+            if (buffers[t].events[i].column >= limit) limit = buffers[t].events[i].column + 1;
+        }
+    }
+    return limit;
+}
+
+void trace_print_summary(FILE* out) {
+    double scale = 1.0 / ticks_per_ns() / 1e6;    // такты -> мс
+    long total_events = 0;
+    long dropped = 0;
+    int threads = 0;
+    for (int t = 0; t < TRACE_MAX_THREADS; t++) {
+        total_events += buffers[t].count;
+        dropped += buffers[t].dropped;
+        if (buffers[t].count > 0) threads = t + 1;
+    }
+
+    fprintf(out, "\n=== Трассировка ===\n");
+    if (total_events == 0) {
+        fprintf(out, "Событий нет: инструментирован параллельный путь -a gauss (-t > 1)\n");
+        return;
+    }
+
+    double phase_time[TRACE_PHASE_COUNT] = {0};
+    long phase_events[TRACE_PHASE_COUNT] = {0};
+    uint64_t phase_counters[TRACE_PHASE_COUNT][TRACE_COUNTER_COUNT];
+    memset(phase_counters, 0, sizeof(phase_counters));
+
+    int columns = column_limit();
+    double* dispatch = (double*)calloc(columns, sizeof(double));
+    double* busy_sum = (double*)calloc(columns, sizeof(double));
+    double* busy_max = (double*)calloc(columns, sizeof(double));
+    int* busy_count = (int*)calloc(columns, sizeof(int));
+    double thread_busy[TRACE_MAX_THREADS] = {0};
+    double thread_dispatched_busy[TRACE_MAX_THREADS] = {0};
+
+    if (!dispatch || !busy_sum || !busy_max || !busy_count) {
+        free(dispatch);
+        free(busy_sum);
+        free(busy_max);
+        free(busy_count);
+        return;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < buffers[t].count; i++) {
+            const TraceEvent* event = &buffers[t].events[i];
+            double duration = (double)(event->end - event->start) * scale;
+            phase_time[event->phase] += duration;
+            phase_events[event->phase]++;
+            for (int k = 0; k < TRACE_COUNTER_COUNT; k++) {
+                phase_counters[event->phase][k] += event->counters[k];
+            }
+            if (event->phase == TRACE_DISPATCH) {
+                dispatch[event->column] += duration;
+            } else {
+                thread_busy[t] += duration;
+            }
+        }
+    }
+
+    // Вторым проходом: занятость только внутри раздач, по ней ожидание и дисбаланс
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < buffers[t].count; i++) {
+            const TraceEvent* event = &buffers[t].events[i];
+            if (event->phase != TRACE_ELIMINATE || dispatch[event->column] == 0.0) continue;
+            double duration = (double)(event->end - event->start) * scale;
+            busy_sum[event->column] += duration;
+            busy_count[event->column]++;
+            if (duration > busy_max[event->column]) busy_max[event->column] = duration;
+            thread_dispatched_busy[t] += duration;
+        }
+    }
+
+    double dispatch_total = 0.0;
+    double imbalance_loss = 0.0;
+    double overhead = 0.0;
+    double ratio_sum = 0.0;
+    double worst_ratio = 0.0;
+    int worst_column = -1;
+    int dispatched_columns = 0;
+    for (int c = 0; c < columns; c++) {
+        if (dispatch[c] == 0.0 || busy_count[c] == 0) continue;
+        double mean = busy_sum[c] / busy_count[c];
+        double ratio = mean > 0.0 ? busy_max[c] / mean : 1.0;
+        dispatch_total += dispatch[c];
+        imbalance_loss += busy_max[c] - mean;
+        overhead += dispatch[c] - busy_max[c];
+        ratio_sum += ratio;
+        dispatched_columns++;
+        if (ratio > worst_ratio) {
+            worst_ratio = ratio;
+            worst_column = c;
+        }
+    }
+
+    int have_counters = use_hardware_counters && buffers[0].perf_fd > 0;
+    fprintf(out, "Фаза       | Событий  | Время (мс)   ");
+    if (have_counters) fprintf(out, "| Циклы          | Инструкции     | Промахи кэша   | IPC");
+    fprintf(out, "\n");
+    for (int p = 0; p < TRACE_PHASE_COUNT; p++) {
+        fprintf(out, "%-10s | %8ld | %12.3f ", phase_names[p], phase_events[p], phase_time[p]);
+        if (have_counters) {
+            uint64_t cycles = phase_counters[p][0];
+            fprintf(out, "| %14llu | %14llu | %14llu | %.2f",
+                    (unsigned long long)cycles, (unsigned long long)phase_counters[p][1],
+                    (unsigned long long)phase_counters[p][2],
+                    cycles ? (double)phase_counters[p][1] / cycles : 0.0);
+        }
+        fprintf(out, "\n");
+    }
+    if (use_hardware_counters && !have_counters) {
+        fprintf(out, "Аппаратные счетчики недоступны (perf_event_open запрещен или не поддерживается)\n");
+    }
+
+    fprintf(out, "Поток | Занят (мс)   | Ожидание в раздачах (мс) | Доля ожидания\n");
+    for (int t = 0; t < threads; t++) {
+        double wait = dispatch_total - thread_dispatched_busy[t];
+        if (wait < 0.0) wait = 0.0;
+        fprintf(out, "%5d | %12.3f | %24.3f | %6.1f%%\n", t, thread_busy[t], wait,
+                dispatch_total > 0.0 ? wait / dispatch_total * 100 : 0.0);
+    }
+
+    if (dispatched_columns > 0) {
+        fprintf(out, "Раздач: %d, в среднем max/mean по потокам: %.3f, худший столбец %d: %.3f\n",
+                dispatched_columns, ratio_sum / dispatched_columns, worst_column, worst_ratio);
+        fprintf(out, "Потери на дисбаланс: %.3f мс, накладные расходы раздачи сверх самого долгого потока: %.3f мс из %.3f мс\n",
+                imbalance_loss, overhead, dispatch_total);
+    }
+    if (dropped > 0) {
+        fprintf(out, "Пропущено событий (буфер потока полон): %ld\n", dropped);
+    }
+
+    free(dispatch);
+    free(busy_sum);
+    free(busy_max);
+    free(busy_count);
+}
+
+// Формат Chrome trace event (chrome://tracing, Perfetto): события "X" с началом и длительностью в мкс
+int trace_write_chrome(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Ошибка: не удалось открыть '%s' для записи трассы\n", path);
+        return 0;
+    }
+
+    double scale = 1.0 / ticks_per_ns() / 1e3;    // такты -> мкс
+    int first = 1;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    for (int t = 0; t < TRACE_MAX_THREADS; t++) {
+        if (buffers[t].count == 0) continue;
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"поток %d\"}}",
+                first ? "" : ",\n", t, t);
+        first = 0;
+
+        for (int i = 0; i < buffers[t].count; i++) {
+            const TraceEvent* event = &buffers[t].events[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"lu\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"column\":%d",
+                    phase_names[event->phase], t, (double)(event->start - origin_ticks) * scale,
+                    (double)(event->end - event->start) * scale, event->column);
+            if (use_hardware_counters && buffers[t].perf_fd > 0) {
+                for (int k = 0; k < TRACE_COUNTER_COUNT; k++) {
+                    fprintf(file, ",\"%s\":%llu", counter_names[k], (unsigned long long)event->counters[k]);
+                }
+            }
+            fprintf(file, "}}");
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    int ok = fclose(file) == 0;
+    if (ok) {
+        printf("Трасса сохранена: %s\n", path);
+    }
+    return ok;
+}
@@ -0,0 +1,48 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Инструментирование горячего пути algorithm_parallel: собирается только с make TRACE=1 (-DDET_TRACE),
+// без него макросы TRACE_BEGIN/TRACE_END пустые и в коде ничего не остается
+typedef enum {
+    TRACE_PIVOT,        // поиск и выбор опорного элемента (поток 0)
+    TRACE_SWAP,         // перестановка строк (поток 0)
+    TRACE_DISPATCH,     // thread_pool_run целиком: раздача, своя доля, ожидание остальных (поток 0)
+    TRACE_ELIMINATE,    // исключение своей полосы строк (каждый поток)
+    TRACE_PHASE_COUNT
+} TracePhase;
+
+#define TRACE_MAX_THREADS 256
+#define TRACE_EVENTS_PER_THREAD (1 << 18)
+#define TRACE_COUNTER_COUNT 3   // циклы, инструкции, промахи кэша
+
+typedef struct {
+    uint64_t start;
+    uint64_t counters[TRACE_COUNTER_COUNT];
+} TraceSpan;
+
+extern int trace_enabled;
+
+int trace_compiled_in(void);
+
+// hardware_counters: счетчики perf_event_open на каждом потоке, если ядро их дает
+void trace_enable(int hardware_counters);
+
+void trace_span_begin(TraceSpan* span, int thread);
+void trace_span_end(const TraceSpan* span, int thread, TracePhase phase, int column);
+
+void trace_print_summary(FILE* out);
+int trace_write_chrome(const char* path);
+
+#ifdef DET_TRACE
+#define TRACE_BEGIN(span, thread) TraceSpan span = {0}; if (trace_enabled) trace_span_begin(&span, (thread))
+#define TRACE_END(span, thread, phase, column) \
+    do { if (trace_enabled) trace_span_end(&span, (thread), (phase), (column)); } while (0)
+#else
+#define TRACE_BEGIN(span, thread) ((void)0)
+#define TRACE_END(span, thread, phase, column) ((void)0)
+#endif
+
+#endif
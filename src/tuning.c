@@ -0,0 +1,271 @@
+#define _POSIX_C_SOURCE 200112L
+#include "tuning.h"
+#include "determinant.h"
+#include "kernels.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Отсчет замера не короче этого: короткие шаги повторяются внутри отсчета
+#define TUNING_MIN_SAMPLE 2e-3
+#define TUNING_SAMPLES 5
+#define TUNING_BLOCK_MATRIX 512
+
+TuningProfile tuning = {
+    2, 64,
+    {128, 256, 512, 1024},
+    {0, 0, 0, 0},
+    0
+};
+
+static const int serial_probe_rows[] = {8, 16, 32, 64, 128, 256, 512};
+static const int block_candidates[] = {16, 32, 48, 64, 96, 128};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int tuning_serial_rows(int threads) {
+    return threads * tuning.serial_rows_per_thread;
+}
+
+int tuning_threads_for_size(int size, int max_threads) {
+    int k = 0;
+    while (k + 1 < TUNING_SIZE_COUNT && tuning.sizes[k + 1] <= size) {
+        k++;
+    }
+    int threads = tuning.threads[k];
+    return threads > 0 && threads < max_threads ? threads : max_threads;
+}
+
+int tuning_load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+
+    TuningProfile profile = tuning;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char key[64];
+        int value;
+        if (line[0] == '#' || sscanf(line, "%63[^=]=%d", key, &value) != 2) continue;
+
+        if (strcmp(key, "serial_rows_per_thread") == 0 && value >= 1 && value <= 1 << 20) {
+            profile.serial_rows_per_thread = value;
+        } else if (strcmp(key, "block_size") == 0 && value >= 8 && value <= 1024) {
+            profile.block_size = value;
+        } else if (strncmp(key, "threads_", 8) == 0 && value >= 0) {
+            int size = atoi(key + 8);
+            for (int k = 0; k < TUNING_SIZE_COUNT; k++) {
+                if (tuning.sizes[k] == size) profile.threads[k] = value;
+            }
+        }
+    }
+    fclose(file);
+
+    profile.loaded = 1;
+    tuning = profile;
+    return 1;
+}
+
+int tuning_save(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Ошибка: не удалось записать профиль '%s'\n", path);
+        return 0;
+    }
+
+    fprintf(file, "# Профиль determinant --tune: CPU %ld, ядро %s, алгоритм %s\n",
+            sysconf(_SC_NPROCESSORS_ONLN), kernel_name(), determinant_get_algorithm()->name);
+    fprintf(file, "serial_rows_per_thread=%d\n", tuning.serial_rows_per_thread);
+    fprintf(file, "block_size=%d\n", tuning.block_size);
+    for (int k = 0; k < TUNING_SIZE_COUNT; k++) {
+        fprintf(file, "threads_%d=%d\n", tuning.sizes[k], tuning.threads[k]);
+    }
+
+    return fclose(file) == 0;
+}
+
+void tuning_print(void) {
+    printf("Последовательный шаг: меньше %d строк на поток\n", tuning.serial_rows_per_thread);
+    printf("Ширина панели блочного LU: %d\n", tuning.block_size);
+    printf("Потоков по размерам:");
+    for (int k = 0; k < TUNING_SIZE_COUNT; k++) {
+        if (tuning.threads[k] > 0) {
+            printf(" от %d: %d;", tuning.sizes[k], tuning.threads[k]);
+        } else {
+            printf(" от %d: все;", tuning.sizes[k]);
+        }
+    }
+    printf("\n");
+}
+
+static void fill_random(double** data, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            data[i][j] = (double)(rand() % 21 - 10);
+        }
+        data[i][i] += 50.0;
+    }
+}
+
+// Один шаг исключения над rows строками длины rows: последовательно или раздачей пулу
+static double time_elimination_step(int rows, int threads) {
+    double** data = allocate_matrix_data(rows + 1);
+    PivotCandidate* candidates = NULL;
+    if (!data || posix_memalign((void**)&candidates, MATRIX_ALIGNMENT, threads * sizeof(PivotCandidate)) != 0) {
+        free_matrix_data(data, rows + 1);
+        return 0.0;
+    }
+    fill_random(data, rows + 1);
+
+    RowEliminationData step;
+    step.matrix = data;
+    step.size = rows + 1;
+    step.pivot_row = 0;
+    step.start_row = 1;
+    step.end_row = rows + 1;
+    step.candidates = candidates;
+    step.counters = NULL;
+    step.chunk = 0;
+
+    ThreadPool* pool = threads > 1 ? thread_pool_shared(threads) : NULL;
+    int inner = 1;
+    double best = 0.0;
+
+    // После первого прохода столбец под опорным нулевой, дальше работа шага та же
+    for (int s = -1; s < TUNING_SAMPLES; s++) {
+        double start = now_seconds();
+        for (int k = 0; k < inner; k++) {
+            if (threads == 1) {
+                eliminate_rows_task(&step, 0, 1);
+            } else {
+                thread_pool_run(pool, threads, eliminate_rows_task, &step);
+            }
+        }
+        double elapsed = (now_seconds() - start) / inner;
+        if (s < 0) {
+            inner = elapsed < TUNING_MIN_SAMPLE ? (int)(TUNING_MIN_SAMPLE / (elapsed > 1e-9 ? elapsed : 1e-9)) + 1 : 1;
+        } else if (s == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    free(candidates);
+    free_matrix_data(data, rows + 1);
+    return best;
+}
+
+static double time_algorithm(const Matrix* matrix, int threads, int repeats) {
+    double best = 0.0;
+    for (int r = 0; r < repeats; r++) {
+        double start = now_seconds();
+        determinant_get_algorithm()->function(matrix, threads);
+        double elapsed = now_seconds() - start;
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static double time_block_size(const Matrix* matrix, int block_size, int threads) {
+    tuning.block_size = block_size;
+    double best = 0.0;
+    for (int r = 0; r < 3; r++) {
+        double** a = copy_matrix_data(matrix);
+        if (!a) return 0.0;
+        int swaps = 0;
+        double start = now_seconds();
+        lu_factor_block(a, matrix->size, threads, &swaps);
+        double elapsed = now_seconds() - start;
+        free_matrix_data(a, matrix->size);
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int tuning_run(int max_threads, const char* path) {
+    printf("=== Настройка под машину: до %d потоков, алгоритм %s, ядро %s ===\n",
+           max_threads, determinant_get_algorithm()->name, kernel_name());
+
+    // Замеры без влияния старого профиля
+    TuningProfile measured = {2, 64, {128, 256, 512, 1024}, {0, 0, 0, 0}, 0};
+    tuning = measured;
+
+    // 1. Порог: наименьший шаг, который раздачей пулу считается быстрее, чем одним потоком
+    if (max_threads > 1) {
+        int probes = (int)(sizeof(serial_probe_rows) / sizeof(serial_probe_rows[0]));
+        int crossover = serial_probe_rows[probes - 1] * 2;
+        printf("Шаг исключения (строк): последовательно / %d потоков, мкс\n", max_threads);
+        for (int p = 0; p < probes; p++) {
+            int rows = serial_probe_rows[p];
+            double serial = time_elimination_step(rows, 1);
+            double parallel = time_elimination_step(rows, max_threads);
+            printf("  %5d: %10.3f / %10.3f\n", rows, serial * 1e6, parallel * 1e6);
+            if (parallel < serial && crossover > rows) {
+                crossover = rows;
+            } else if (parallel >= serial) {
+                crossover = serial_probe_rows[probes - 1] * 2;
+            }
+        }
+        measured.serial_rows_per_thread = (crossover + max_threads - 1) / max_threads;
+        tuning.serial_rows_per_thread = measured.serial_rows_per_thread;
+    }
+
+    // 2. Ширина панели блочного LU
+    Matrix* matrix = matrix_create(TUNING_BLOCK_MATRIX);
+    if (!matrix) return 0;
+    fill_random(matrix->data, TUNING_BLOCK_MATRIX);
+
+    printf("Блочное LU %dx%d, ширина панели: мс\n", TUNING_BLOCK_MATRIX, TUNING_BLOCK_MATRIX);
+    double best_block_time = 0.0;
+    int candidates = (int)(sizeof(block_candidates) / sizeof(block_candidates[0]));
+    for (int c = 0; c < candidates; c++) {
+        double elapsed = time_block_size(matrix, block_candidates[c], max_threads);
+        printf("  %5d: %10.3f\n", block_candidates[c], elapsed * 1e3);
+        if (c == 0 || elapsed < best_block_time) {
+            best_block_time = elapsed;
+            measured.block_size = block_candidates[c];
+        }
+    }
+    tuning.block_size = measured.block_size;
+    matrix_free(matrix);
+
+    // 3. Число потоков по размерам: 1, 2, 4... и само max_threads
+    for (int k = 0; k < TUNING_SIZE_COUNT; k++) {
+        int size = measured.sizes[k];
+        matrix = matrix_create(size);
+        if (!matrix) return 0;
+        fill_random(matrix->data, size);
+
+        printf("Размер %d, потоков: мс\n", size);
+        double best_time = 0.0;
+        int threads = 1;
+        for (;;) {
+            double elapsed = time_algorithm(matrix, threads, 3);
+            printf("  %5d: %10.3f\n", threads, elapsed * 1e3);
+            if (threads == 1 || elapsed < best_time) {
+                best_time = elapsed;
+                measured.threads[k] = threads;
+            }
+            if (threads == max_threads) break;
+            threads = threads * 2 < max_threads ? threads * 2 : max_threads;
+        }
+        // Все потоки - без ограничения: профиль не режет более широкий -t
+        if (measured.threads[k] == max_threads) measured.threads[k] = 0;
+        matrix_free(matrix);
+    }
+
+    measured.loaded = 1;
+    tuning = measured;
+    thread_pool_shutdown_shared();
+
+    printf("\nВыбрано:\n");
+    tuning_print();
+    if (!tuning_save(path)) return 0;
+    printf("Профиль сохранен: %s\n", path);
+    return 1;
+}
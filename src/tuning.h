@@ -0,0 +1,31 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+// Профиль машины (--tune): сохраняется в текущем каталоге и читается при каждом запуске
+#define TUNING_PROFILE_FILE ".determinant_profile"
+#define TUNING_SIZE_COUNT 4
+
+typedef struct {
+    int serial_rows_per_thread;         // шаг исключения идет на одном потоке, пока строк меньше потоков * это
+    int block_size;                     // ширина панели блочного LU
+    int sizes[TUNING_SIZE_COUNT];       // размеры, на которых подбиралось число потоков
+    int threads[TUNING_SIZE_COUNT];     // лучшее число потоков от sizes[i], 0 - сколько задано -t
+    int loaded;
+} TuningProfile;
+
+extern TuningProfile tuning;
+
+// Порог последовательного шага для данного числа потоков (было max_threads * 2)
+int tuning_serial_rows(int threads);
+
+// Не больше max_threads; для размеров между замерами берется ближайший меньший
+int tuning_threads_for_size(int size, int max_threads);
+
+int tuning_load(const char* path);
+int tuning_save(const char* path);
+void tuning_print(void);
+
+// Замеры на этой машине с потоками до max_threads, затем сохранение в path
+int tuning_run(int max_threads, const char* path);
+
+#endif
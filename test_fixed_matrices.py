@@ -1,51 +1,27 @@
 #!/usr/bin/env python3
 
 import subprocess
-import re
 import json
 import matplotlib.pyplot as plt
 import numpy as np
 import os
 
-def run_test_with_file(matrix_file, threads):
+def run_benchmark_with_file(matrix_file, thread_counts):
+    """Один запуск встроенного бенчмарка: строка JSON на каждую точку"""
     try:
-        cmd = ["./determinant", "-f", matrix_file, "-t", str(threads)]
-        result = subprocess.run(cmd, capture_output=True, text=True, timeout=120)
+        cmd = ["./determinant", "--bench", "-f", matrix_file,
+               "--bench-threads", ",".join(str(t) for t in thread_counts),
+               "--output", "jsonl"]
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=3600)
         
         if result.returncode != 0:
-            print(f"    ❌ Ошибка: {result.stderr}")
+            print(f"    ❌ Ошибка: {result.stdout}{result.stderr}")
             return None
-            
-        output = result.stdout
-        
-        data = {}
         
-        # Парсим детерминант (включая inf и -inf)
-        det_match = re.search(r'Детерминант:\s*([-+]?(?:\d+\.?\d*|inf))', output, re.IGNORECASE)
-        if det_match:
-            det_str = det_match.group(1)
-            if 'inf' in det_str.lower():
-                data['determinant'] = str(float('inf') if det_str[0] != '-' else float('-inf'))
-            else:
-                data['determinant'] = float(det_str)
-            
-        speedup_match = re.search(r'Ускорение:\s*([\d.]+)x', output)
-        if speedup_match:
-            data['speedup'] = float(speedup_match.group(1))
-            
-        eff_match = re.search(r'Эффективность:\s*([\d.]+)%', output)
-        if eff_match:
-            data['efficiency'] = float(eff_match.group(1))
-            
-        seq_time_match = re.search(r'Время последовательно:\s*([\d.]+)\s*сек', output)
-        if seq_time_match:
-            data['sequential_time'] = float(seq_time_match.group(1))
-            
-        par_time_match = re.search(r'Время параллельно:\s*([\d.]+)\s*сек', output)
-        if par_time_match:
-            data['parallel_time'] = float(par_time_match.group(1))
-        
-        return data
+        points = [json.loads(line) for line in result.stdout.splitlines() if line.startswith('{')]
+        sequential = next((p for p in points if p['variant'] == 'sequential'), None)
+        parallel = {p['threads']: p for p in points if p['variant'] != 'sequential'}
+        return sequential, parallel
         
     except Exception as e:
         print(f"    ❌ Ошибка: {e}")
@@ -79,28 +55,46 @@ def main():
             'efficiency': [],
             'sequential_times': [],
             'parallel_times': [],
-            'determinant': None
+            'parallel_p95': [],
+            'parallel_stddev': [],
+            'gflops': [],
+            'determinant': None,
+            'log_abs_determinant': None,
+            'sign': None
         }
         
+        measured = run_benchmark_with_file(matrix_file, thread_counts)
+        if not measured:
+            print("❌")
+            continue
+        sequential, parallel = measured
+        if sequential is None:
+            print("    ❌ Ошибка: в выводе бенчмарка нет последовательного замера, матрица пропущена")
+            continue
+        
+        size_data['determinant'] = sequential['determinant']
+        size_data['log_abs_determinant'] = sequential['log_abs_determinant']
+        size_data['sign'] = sequential['sign']
+        
         for threads in thread_counts:
-            print(f"  Потоки: {threads:2d}...", end=" ")
+            data = parallel.get(threads)
+            if not data:
+                print(f"  Потоки: {threads:2d}... ❌")
+                continue
             
-            data = run_test_with_file(matrix_file, threads)
+            size_data['threads'].append(threads)
+            size_data['speedup'].append(data['speedup'])
+            size_data['efficiency'].append(data['efficiency'] * 100)
+            size_data['sequential_times'].append(sequential['median'])
+            size_data['parallel_times'].append(data['median'])
+            size_data['parallel_p95'].append(data['p95'])
+            size_data['parallel_stddev'].append(data['stddev'])
+            size_data['gflops'].append(data['gflops'])
             
-            if data:
-                size_data['threads'].append(threads)
-                size_data['speedup'].append(data.get('speedup', 0))
-                size_data['efficiency'].append(data.get('efficiency', 0))
-                size_data['sequential_times'].append(data.get('sequential_time', 0))
-                size_data['parallel_times'].append(data.get('parallel_time', 0))
-                
-                if size_data['determinant'] is None and 'determinant' in data:
-                    size_data['determinant'] = data['determinant']
-                
-                print(f"Ускорение: {data.get('speedup', 0):5.2f}x, Эффективность: {data.get('efficiency', 0):5.1f}%")
-                print(f"Последовательное время: {data.get('sequential_time', 0):5.3f} сек ({(data.get('sequential_time', 0) * 1000):5.0f} мс), Параллельное время: {data.get('parallel_time', 0):5.3f} сек ({(data.get('parallel_time', 0) * 1000):5.0f} мс)")
-            else:
-                print("❌")
+            print(f"  Потоки: {threads:2d}... Ускорение: {data['speedup']:5.2f}x, Эффективность: {data['efficiency'] * 100:5.1f}%, "
+                  f"{data['gflops']:6.2f} ГФлоп/с")
+            print(f"Последовательно (медиана): {sequential['median']:5.3f} сек, Параллельно (медиана): {data['median']:5.3f} сек, "
+                  f"p95: {data['p95']:5.3f} сек, СКО: {data['stddev'] * 1000:5.1f} мс, замеров: {data['runs']}")
         
         results[matrix_name] = size_data
     